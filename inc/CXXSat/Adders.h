@@ -0,0 +1,41 @@
+#ifndef ADDERS_H_INC
+#define ADDERS_H_INC
+
+#include <CXXSat/Circuit.h>
+#include <CXXSat/BitView.h>
+
+//Adder networks over runs of n bits, least significant bit first.  The
+//sum is written to sum[0, n), which must not overlap a or b, and the
+//carry out of the top bit is returned.  They all compute the same
+//function and differ only in the shape of the carry network: ripple is
+//smallest but as deep as the operands are wide, while the prefix
+//networks are logarithmic in depth at the cost of more gates.  The bits
+//are passed by pointer so they can live anywhere (a BitVector, a
+//FixedVariable's array) without being copied.
+typedef BitVector AdderBits;
+
+Circuit::Value RippleAdder(Circuit::Value* sum, const Circuit::Value* a,
+        const Circuit::Value* b, unsigned n, const Circuit::Value& carry);
+//4 bit lookahead groups, rippling between groups
+Circuit::Value CarryLookaheadAdder(Circuit::Value* sum, const Circuit::Value* a,
+        const Circuit::Value* b, unsigned n, const Circuit::Value& carry);
+Circuit::Value KoggeStoneAdder(Circuit::Value* sum, const Circuit::Value* a,
+        const Circuit::Value* b, unsigned n, const Circuit::Value& carry);
+Circuit::Value BrentKungAdder(Circuit::Value* sum, const Circuit::Value* a,
+        const Circuit::Value* b, unsigned n, const Circuit::Value& carry);
+//ripple blocks of about sqrt(n) bits, each computed for both carries in
+Circuit::Value CarrySelectAdder(Circuit::Value* sum, const Circuit::Value* a,
+        const Circuit::Value* b, unsigned n, const Circuit::Value& carry);
+
+Circuit::Value AddBits(Circuit::Adder, Circuit::Value* sum, const Circuit::Value* a,
+        const Circuit::Value* b, unsigned n, const Circuit::Value& carry);
+//a and b must be the same length; sum is resized to match
+inline Circuit::Value AddBits(Circuit::Adder type, AdderBits& sum, const AdderBits& a,
+        const AdderBits& b, const Circuit::Value& carry)
+{
+    assert(a.size() == b.size());
+    sum.resize(a.size());
+    return AddBits(type, sum.data(), a.data(), b.data(), a.size(), carry);
+}
+
+#endif
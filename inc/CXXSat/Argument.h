@@ -52,6 +52,12 @@ public:
     void print(std::ostream&, const Solution&) const;
     std::string toString(const Solution&) const;
     FlexInt solution(const Solution&) const;
+    //the CNF variables of the bits, lowest first, as numbered by the last
+    //generateCNF; for projecting solutions onto the argument
+    std::vector<int> variables() const;
+    //the CNF variables of the n most significant bits, highest first, as
+    //numbered by the last generateCNF; for splitting a problem into cubes
+    std::vector<int> topBits(unsigned n) const;
 };
 
 template <class Int>
@@ -0,0 +1,44 @@
+#ifndef BITVIEW_H_INC
+#define BITVIEW_H_INC
+
+#include <CXXSat/Circuit.h>
+#include <CXXSat/SmallVector.h>
+
+//Storage for the bits of a Variable, least significant first.  64 bits
+//and narrower live inline.
+typedef SmallVector<Circuit::Value, 64> BitVector;
+
+//A read only view of a run of bits, least significant first, made from
+//slices of existing bit vectors and runs of one repeated bit (for
+//extension and shifted in zeros).  Slicing and concatenating views
+//only rearranges the pieces; nothing is copied until the view is
+//appended to a BitVector.  The viewed vectors must outlive the view.
+class BitView {
+public:
+    BitView() = default;
+    BitView(const BitVector& v) : BitView(v.data(), v.size()) {}
+    BitView(const Circuit::Value* bits, unsigned n);
+    //n copies of bit
+    static BitView fill(const Circuit::Value& bit, unsigned n);
+    unsigned size() const {
+        return length;
+    }
+    const Circuit::Value& operator[](unsigned) const;
+    //bits [lo, hi)
+    BitView slice(unsigned lo, unsigned hi) const;
+    //lo in the low bits, hi above it
+    friend BitView concat(const BitView& lo, const BitView& hi);
+    void appendTo(BitVector&) const;
+private:
+    struct Piece {
+        //nullptr for a run of fill
+        const Circuit::Value* bits;
+        unsigned size;
+        Circuit::Value fill;
+    };
+    void append(const Piece&);
+    SmallVector<Piece, 4> pieces;
+    unsigned length = 0;
+};
+
+#endif
@@ -23,7 +23,10 @@
 
 class Argument;
 class Variable;
+class Expr;
 class Problem;
+class ClauseSink;
+class SolverSession;
 
 class Circuit {
 public:
@@ -45,6 +48,31 @@ private:
     std::shared_ptr<impl> pimpl;
     const std::weak_ptr<impl>& pimpl_get_self() const;
 public:
+    //Circuit used to implement Variable::DivRem
+    enum class Divider : char {
+        RESTORING,
+        NON_RESTORING
+    };
+    //Carry network used for addition, subtraction and comparison
+    enum class Adder : char {
+        RIPPLE,
+        CARRY_LOOKAHEAD,
+        KOGGE_STONE,
+        BRENT_KUNG,
+        CARRY_SELECT
+    };
+    //Overrides the circuit's adder while in scope, for choosing the
+    //architecture of individual operations
+    class AdderScope {
+    private:
+        std::weak_ptr<impl> circuit;
+        Adder saved;
+    public:
+        AdderScope(const std::weak_ptr<impl>&, Adder);
+        AdderScope(const Circuit& c, Adder a) : AdderScope(c.getPimpl(), a) {}
+        AdderScope(const AdderScope&) = delete;
+        ~AdderScope();
+    };
     Circuit();
     Circuit(const Circuit&) = delete;
     Circuit(Circuit&& c) = default;
@@ -63,8 +91,23 @@ public:
     Variable getLiteral(Int i) const;
     template <class Int>
     static Variable getLiteral(const std::weak_ptr<Circuit::impl>&, Int);
+    //every gate in the circuit
     Problem generateCNF() const;
+    //only the gates the target depends on, so values that never reach it
+    //(unused locals, high bits lost to a truncation) cost nothing
     Problem generateCNF(const Variable&) const;
+    //bit-blasts the expression first
+    Problem generateCNF(const Expr&) const;
+    //writes what generateCNF(const Variable&) would return to the file
+    //descriptor as DIMACS, without building the Problem in memory; throws
+    //std::system_error if it can't all be written
+    void writeDIMACS(const Variable&, int fd) const;
+    void setDivider(Divider);
+    Divider getDivider() const;
+    static Divider getDivider(const std::weak_ptr<Circuit::impl>&);
+    void setAdder(Adder);
+    Adder getAdder() const;
+    static Adder getAdder(const std::weak_ptr<Circuit::impl>&);
 };
 
 static inline bool circuitsEqual(const std::weak_ptr<Circuit::impl>& a,
@@ -79,7 +122,6 @@ class Circuit::Node {
 protected:
     enum class NODE_TYPE : char {
         INPUT,
-        VALUE,
         GATE
     };
     std::weak_ptr<Circuit::impl> circuit;
@@ -96,15 +138,6 @@ public:
     Input* asInput() {
         return (Input*)this;
     }
-    bool isValue() const {
-        return type == NODE_TYPE::VALUE;
-    }
-    const Value* asValue() const {
-        return (const Value*)this;
-    }
-    Value* asValue() {
-        return (Value*)this;
-    }
     bool isGate() const {
         return type == NODE_TYPE::GATE;
     }
@@ -121,42 +154,65 @@ public:
 
 class Circuit::Wire {
     friend class Circuit;
+    friend class ::SolverSession;
+    friend class Value;
 public:
     explicit Wire(const std::shared_ptr<Node>& n);
     virtual ~Wire();
     virtual int ID() const = 0;
-    void connect(const Node* n) {
-        //EVIL!
-        auto x = to.emplace(const_cast<Node*>(n), 1);
-        if (!x.second) {
-            ++(x.first->second);
-        }
+    //Only the number of readers is tracked, not who they are: copying a
+    //Value happens constantly and mustn't allocate.
+    void connect(const Node*) {
+        ++fanout;
     }
-    void disconnect(const Node* n) {
-        auto it = to.find(const_cast<Node*>(n));
-        assert(it != to.end());
-        if (--(it->second) == 0) {
-            to.erase(it);
-        }
+    void disconnect(const Node*) {
+        assert(fanout > 0);
+        --fanout;
+    }
+    unsigned numReaders() const {
+        return fanout;
     }
-    const std::weak_ptr<Circuit::impl>& getCircuit() {
+    const std::weak_ptr<Circuit::impl>& getCircuit() const {
         return c;
     }
     void swapSource(std::shared_ptr<Node>& p) {
         std::swap(from, p);
     }
+    const std::shared_ptr<Node>& source() const {
+        return from;
+    }
+    //-1 if this wire is not driven by a literal, otherwise its value
+    int literal() const;
 protected:
     std::shared_ptr<Node> from;
-#ifdef USE_UNORDERED
-    //tests suggest that this is slower than std::map<>, but
-    //not by a significant amount - so some applications might
-    //benefit using unordered vice ordered maps.
-    std::unordered_map<Node*, unsigned> to;
-#else
-    std::map<Node*, unsigned> to;
-#endif
+    unsigned fanout = 0;
     std::weak_ptr<Circuit::impl> c;
     virtual bool setID(int) = 0;
+private:
+    //Values point at their wire rather than sharing ownership of it, so
+    //the wire owns itself while any Value reads it
+    std::shared_ptr<Wire> self;
+    unsigned values = 0;
+    void hold(const std::shared_ptr<Wire>& w) {
+        assert(w.get() == this);
+        if (values++ == 0) {
+            self = w;
+        }
+        ++fanout;
+    }
+    void hold() {
+        assert(values > 0);
+        ++values;
+        ++fanout;
+    }
+    void release() {
+        assert(values > 0 && fanout > 0);
+        --fanout;
+        if (--values == 0) {
+            //may be the last owner, so nothing is touched after this
+            auto last = std::move(self);
+        }
+    }
 };
 
 class Circuit::BasicWire : public Circuit::Wire {
@@ -180,9 +236,11 @@ public:
     bool setID(int) {
         return false;
     }
+    std::shared_ptr<Wire> inverse() const;
 };
 
 class Circuit::Input : public Circuit::Node {
+    friend class Circuit;
 public:
     static std::shared_ptr<Input> create(std::weak_ptr<Circuit::impl> c) {
         auto ptr = std::make_shared<Input>(std::move(c));
@@ -208,58 +266,58 @@ public:
     int getID() const {
         return getWire()->ID();
     }
+    int literal() const {
+        return lit;
+    }
     //DO NOT USE
     explicit Input(std::weak_ptr<Circuit::impl> c) : Node(c, NODE_TYPE::INPUT), initialized(false) {}
 private:
     mutable std::weak_ptr<Wire> out_wire;
     mutable bool initialized;
     std::weak_ptr<Node> self;
+    //set by the circuit for its two literal inputs
+    signed char lit = -1;
 };
 
-class Circuit::Value : public Circuit::Node {
+inline int Circuit::Wire::literal() const {
+    return from->isInput() ? from->asInput()->literal() : -1;
+}
+
+//One bit of a Variable: a handle on the wire driving it.  It is a single
+//pointer, so the bits of a 64 bit Variable fit inline and copying them
+//doesn't touch shared_ptr reference counts.
+class Circuit::Value {
 public:
-    Value() : Node({}, NODE_TYPE::VALUE) {}
-    Value(const Value& v) 
-        : Node(v.circuit, NODE_TYPE::VALUE), _source(v._source)
-    {
-        _source->connect(this);
-    }
-    Value(Value&& v) : Node(v.circuit, NODE_TYPE::VALUE) {
-        std::swap(v._source, _source);
-        _source->disconnect(&v);
-        _source->connect(this);
-    }
-    explicit Value(const Input& i) 
-        : Node(i.getCircuit(), NODE_TYPE::VALUE), _source(i.getWire())
-    {
-        _source->connect(this);
-    }
-    explicit Value(std::shared_ptr<Wire> w)
-        : Node(w->getCircuit(), NODE_TYPE::VALUE), _source(w)
-    {
-        _source->connect(this);
+    Value() = default;
+    Value(const Value& v) : _source(v._source) {
+        if (_source) {
+            _source->hold();
+        }
+    }
+    Value(Value&& v) : _source(v._source) {
+        v._source = nullptr;
+    }
+    explicit Value(const Input& i) : Value(i.getWire()) {}
+    explicit Value(const std::shared_ptr<Wire>& w) : _source(w.get()) {
+        _source->hold(w);
     }
     Value& operator=(const Value& v) {
-        if (_source) {
-            _source->disconnect(this);
+        if (v._source) {
+            v._source->hold();
         }
-        circuit = v.circuit;
-        _source = v._source;
         if (_source) {
-            _source->connect(this);
+            _source->release();
         }
+        _source = v._source;
         return *this;
     }
     Value& operator=(Value&& v) {
-        if (_source) {
-            _source->disconnect(this);
-            _source.reset();
-        }
-        circuit = v.circuit;
-        std::swap(_source, v._source);
-        if (_source) {
-            _source->connect(this);
-            _source->disconnect(&v);
+        if (this != &v) {
+            if (_source) {
+                _source->release();
+            }
+            _source = v._source;
+            v._source = nullptr;
         }
         return *this;
     }
@@ -272,25 +330,45 @@ public:
     std::shared_ptr<Value> clone() const {
         return std::make_shared<Value>(*this);
     }
-    std::shared_ptr<Wire> source() const {
-        return _source;
+    const std::shared_ptr<Wire>& source() const {
+        static const std::shared_ptr<Wire> none;
+        return _source ? _source->self : none;
     }
     ~Value() {
-        if (_source) _source->disconnect(this);
+        if (_source) _source->release();
+    }
+    const std::weak_ptr<Circuit::impl>& getCircuit() const {
+        static const std::weak_ptr<Circuit::impl> none;
+        return _source ? _source->getCircuit() : none;
     }
     int getID() const {
         return _source->ID();
     }
+    bool isLiteral() const {
+        return _source && _source->literal() >= 0;
+    }
+    //only meaningful if isLiteral()
+    bool literalValue() const {
+        return _source->literal() == 1;
+    }
+    //true if both are driven by the same wire, and so always equal
+    bool sameSource(const Value& v) const {
+        return _source == v._source;
+    }
 private:
-    std::shared_ptr<Wire> _source;
+    Wire* _source = nullptr;
 };
 
 class Circuit::Gate : public Circuit::Node {
     template <class T>
     friend class GateBase;
 public:
-    virtual void emplaceCNF(Problem& p) = 0;
+    virtual void emplaceCNF(ClauseSink& p) = 0;
+    //how many clauses emplaceCNF adds
+    virtual unsigned numClauses() const = 0;
     virtual Problem CNF();
+    virtual unsigned numInputs() const = 0;
+    virtual const std::shared_ptr<Wire>& getInput(unsigned) const = 0;
     std::shared_ptr<Wire> getWire() {
         if (auto wire = out_wire.lock()) {
             return wire;
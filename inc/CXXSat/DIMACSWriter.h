@@ -0,0 +1,38 @@
+#ifndef DIMACSWRITER_H_INC
+#define DIMACSWRITER_H_INC
+
+#include <CXXSat/Sat.h>
+
+#include <memory>
+#include <cstddef>
+
+//Writes clauses to a file descriptor in DIMACS format as they are added,
+//so a problem can be dumped without ever being held in memory.  The
+//header goes out first, so the number of clauses must be known up front;
+//adding a different number is a bug, caught by an assertion.  Output is
+//buffered and written in large blocks with write(2), and a failed write
+//throws std::system_error.
+class DIMACSWriter final : public ClauseSink {
+public:
+    DIMACSWriter(int fd, unsigned vars, std::size_t clauses);
+    DIMACSWriter(const DIMACSWriter&) = delete;
+    DIMACSWriter& operator=(const DIMACSWriter&) = delete;
+    //flushes, ignoring errors
+    ~DIMACSWriter();
+    using ClauseSink::addClause;
+    void addClause(const int* lits, std::size_t n) override;
+    void flush();
+private:
+    static constexpr std::size_t bufsize = 1 << 20;
+    int fd;
+    std::size_t expected;
+    std::size_t written = 0;
+    std::unique_ptr<char[]> buf;
+    std::size_t len = 0;
+    //a write failed, so the output is cut short
+    bool failed = false;
+    void put(const char* s, std::size_t n);
+    void putInt(long long);
+};
+
+#endif
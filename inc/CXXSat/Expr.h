@@ -0,0 +1,143 @@
+#ifndef EXPR_H_INC
+#define EXPR_H_INC
+
+#include <CXXSat/Circuit.h>
+#include <CXXSat/Variable.h>
+#include <CXXSat/TypeInfo.h>
+#include <CXXSat/IntegerTypes.h>
+
+#include <memory>
+#include <vector>
+#include <type_traits>
+
+//Word-level expressions, as an optional layer over Variable.  Operators
+//on Exprs build a DAG instead of gates; no bits exist until the DAG is
+//bit-blasted, which Circuit::generateCNF does for an Expr.  Nodes are
+//hash-consed per circuit, so equal subexpressions are shared (and
+//recognized as equal), and simple identities (x + 0, x * 1, x ^ x,
+//x - x, ~~x, constant operands...) are rewritten as nodes are built.
+//
+//Types follow the usual arithmetic conversions exactly as Variable's
+//operators do, so blasting an Expr gives the same circuit as writing
+//the expression with Variables, minus whatever was simplified away.
+class Expr {
+public:
+    enum class Op : char {
+        LEAF,   //a Variable, possibly constant
+        NOT,
+        NEG,
+        ADD,
+        SUB,
+        MUL,
+        DIV,
+        REM,
+        SHL,
+        SHR,
+        AND,
+        OR,
+        XOR,
+        EQ,
+        LT,
+        ITE,    //operands are condition, then, else
+        CAST
+    };
+    struct Node;
+private:
+    std::shared_ptr<const Node> node;
+    explicit Expr(std::shared_ptr<const Node> n) : node{std::move(n)} {}
+    //finds or creates the node, after simplifying
+    static Expr make(Op, TypeInfo, std::vector<Expr>);
+    static Expr simplify(Op, TypeInfo, const std::vector<Expr>&);
+    static Expr binary(Op, const Expr&, const Expr&);
+    static Expr compare(Op, const Expr&, const Expr&);
+    static Expr logic(Op, const Expr&, const Expr&);
+    //the nodes a node's value is computed from when it is blasted
+    static std::vector<const Node*> dependencies(const Node*);
+    bool isConstant(bool value) const;
+    bool isAllOnes() const;
+    bool isOne() const;
+public:
+    explicit Expr(const Variable&);
+    explicit Expr(const Argument&);
+    template <class Int, class = typename std::enable_if<is_integer<Int>::value>::type>
+    Expr(Int i, const std::weak_ptr<Circuit::impl>& c) : Expr(Variable(i, c)) {}
+    Expr(const FlexInt& i, const std::weak_ptr<Circuit::impl>& c) : Expr(Variable(i, c)) {}
+
+    Op op() const;
+    TypeInfo getTypeInfo() const;
+    const std::weak_ptr<Circuit::impl>& getCircuit() const;
+    unsigned numOperands() const;
+    Expr operand(unsigned) const;
+    //true if both are the same node, which for hash-consed nodes means
+    //the same expression
+    bool same(const Expr& e) const {
+        return node == e.node;
+    }
+    //true for a leaf whose bits are all literals
+    bool isConstant() const;
+    bool isZero() const {
+        return isConstant(false);
+    }
+    //builds the circuit for the whole DAG, sharing common subexpressions
+    Variable blast() const;
+
+    Expr cast(TypeInfo) const;
+    Expr asBit() const;
+    static Expr Ternary(const Expr& cond, const Expr& a, const Expr& b);
+
+    Expr operator~() const;
+    Expr operator-() const;
+    Expr operator+() const;
+    Expr operator!() const;
+    friend Expr operator+(const Expr&, const Expr&);
+    friend Expr operator-(const Expr&, const Expr&);
+    friend Expr operator*(const Expr&, const Expr&);
+    friend Expr operator/(const Expr&, const Expr&);
+    friend Expr operator%(const Expr&, const Expr&);
+    friend Expr operator<<(const Expr&, const Expr&);
+    friend Expr operator>>(const Expr&, const Expr&);
+    friend Expr operator&(const Expr&, const Expr&);
+    friend Expr operator|(const Expr&, const Expr&);
+    friend Expr operator^(const Expr&, const Expr&);
+    friend Expr operator&&(const Expr&, const Expr&);
+    friend Expr operator||(const Expr&, const Expr&);
+    friend Expr operator==(const Expr&, const Expr&);
+    friend Expr operator!=(const Expr&, const Expr&);
+    friend Expr operator<(const Expr&, const Expr&);
+    friend Expr operator>(const Expr&, const Expr&);
+    friend Expr operator<=(const Expr&, const Expr&);
+    friend Expr operator>=(const Expr&, const Expr&);
+};
+
+#define DEFINE_BINARY_OP(op) \
+    template <class Int, class = typename std::enable_if<is_integer<Int>::value>::type> \
+    Expr operator op(const Expr& a, const Int& b) { \
+        return a op Expr(b, a.getCircuit()); \
+    } \
+    template <class Int, class = typename std::enable_if<is_integer<Int>::value>::type> \
+    Expr operator op(const Int& a, const Expr& b) { \
+        return Expr(a, b.getCircuit()) op b; \
+    }
+
+DEFINE_BINARY_OP(+);
+DEFINE_BINARY_OP(-);
+DEFINE_BINARY_OP(*);
+DEFINE_BINARY_OP(/);
+DEFINE_BINARY_OP(%);
+DEFINE_BINARY_OP(<<);
+DEFINE_BINARY_OP(>>);
+DEFINE_BINARY_OP(&);
+DEFINE_BINARY_OP(|);
+DEFINE_BINARY_OP(^);
+DEFINE_BINARY_OP(&&);
+DEFINE_BINARY_OP(||);
+DEFINE_BINARY_OP(==);
+DEFINE_BINARY_OP(!=);
+DEFINE_BINARY_OP(<);
+DEFINE_BINARY_OP(>);
+DEFINE_BINARY_OP(<=);
+DEFINE_BINARY_OP(>=);
+
+#undef DEFINE_BINARY_OP
+
+#endif
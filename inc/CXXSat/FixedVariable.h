@@ -0,0 +1,338 @@
+#ifndef FIXEDVARIABLE_H_INC
+#define FIXEDVARIABLE_H_INC
+
+#include <CXXSat/Circuit.h>
+#include <CXXSat/Variable.h>
+#include <CXXSat/Argument.h>
+#include <CXXSat/Adders.h>
+#include <CXXSat/Gates.h>
+#include <CXXSat/IntegerTypes.h>
+#include <CXXSat/TypeInfo.h>
+
+#include <array>
+#include <memory>
+#include <type_traits>
+
+//A Variable whose width and signedness are part of its type, for code
+//that knows them when it is compiled.  The bits are kept in a
+//std::array, and the type each operator converts its operands to is
+//worked out by the compiler, so no TypeInfo is checked at runtime.  The
+//usual arithmetic conversions apply, but not the promotion to int
+//(CastMode only governs Variable): the types written are the types used.
+//
+//Bitwise operators, sums, comparisons and shifts are built here on the
+//arrays, so their operands and results are never copied to the heap
+//(the gates themselves are, as for any circuit).  Products, quotients
+//and remainders use Variable's implementations, which go through a
+//Variable and its TypeInfo.  Either kind converts to the other.
+template <unsigned N, bool Signed>
+class FixedVariable;
+
+typedef FixedVariable<1, false> FixedBit;
+
+//the type both operands of a binary operator are converted to
+template <unsigned N, bool S, unsigned M, bool T>
+struct FixedCommon {
+    static constexpr unsigned size = (N > M) ? N : M;
+    //the wider operand's signedness, and unsigned if they are as wide
+    static constexpr bool sign = (S == T) ? S : ((N == M) ? false : ((N > M) ? S : T));
+    typedef FixedVariable<size, sign> type;
+};
+
+//the type a host integer becomes when used as an operand
+template <class Int>
+using FixedFor = FixedVariable<sizeof(Int)*8, is_signed_integer<Int>::value>;
+
+template <unsigned N, bool Signed>
+class FixedVariable {
+    static_assert(N > 0, "FixedVariable needs at least one bit");
+    template <unsigned, bool>
+    friend class FixedVariable;
+public:
+    typedef std::array<Circuit::Value, N> Bits;
+
+    explicit FixedVariable(const Argument& arg) : circuit{arg.getCircuit()} {
+        assert(arg.size() == N);
+        for (unsigned i = 0; i < N; ++i) {
+            bits[i] = Circuit::Value(*arg.getInputs()[i]);
+        }
+    }
+    //converts as Variable::cast does; a single bit takes the truth value
+    explicit FixedVariable(const Variable& v) : circuit{v.getCircuit()} {
+        const auto& x = (N == 1) ? v.asBit() : v.cast(getTypeInfo());
+        std::copy(x.bits.begin(), x.bits.end(), bits.begin());
+    }
+    //the constant i, converted to this type
+    template <class Int, class = typename std::enable_if<is_integer<Int>::value>::type>
+    FixedVariable(Int i, const std::weak_ptr<Circuit::impl>& c) : circuit{c} {
+        unsigned n = ::numbits(i);
+        for (unsigned k = 0; k < N; ++k) {
+            bool b = (k < n) ? testbit(i, k) : (signedness(i) && testbit(i, n - 1));
+            bits[k] = b ? Circuit::getLiteralTrue(c) : Circuit::getLiteralFalse(c);
+        }
+    }
+    operator Variable() const {
+        return Variable(circuit, BitView(bits.data(), N), Signed);
+    }
+
+    const std::weak_ptr<Circuit::impl>& getCircuit() const {
+        return circuit;
+    }
+    static constexpr unsigned size() {
+        return N;
+    }
+    static constexpr bool sign() {
+        return Signed;
+    }
+    static TypeInfo getTypeInfo() {
+        return (N == 1) ? TypeInfo::createBit() : TypeInfo(Signed, N);
+    }
+    const Bits& getBits() const {
+        return bits;
+    }
+
+    template <unsigned M, bool T>
+    FixedVariable<M, T> cast() const {
+        FixedVariable<M, T> ret(circuit);
+        for (unsigned i = 0; i < M; ++i) {
+            if (i < N) {
+                ret.bits[i] = bits[i];
+            }
+            else {
+                ret.bits[i] = Signed ? bits[N-1] : Circuit::getLiteralFalse(circuit);
+            }
+        }
+        return ret;
+    }
+    FixedBit asBit() const {
+        FixedBit ret(circuit);
+        ret.bits[0] = (N == 1) ? bits[0] : ::MultiOr(bits);
+        return ret;
+    }
+
+    //Operations on operands of this type
+    static FixedVariable Not(const FixedVariable& a) {
+        FixedVariable ret(a.circuit);
+        for (unsigned i = 0; i < N; ++i) {
+            ret.bits[i] = ::Not(a.bits[i]);
+        }
+        return ret;
+    }
+    static FixedVariable And(const FixedVariable& a, const FixedVariable& b) {
+        return bitwise(a, b, ::And);
+    }
+    static FixedVariable Or(const FixedVariable& a, const FixedVariable& b) {
+        return bitwise(a, b, ::Or);
+    }
+    static FixedVariable Xor(const FixedVariable& a, const FixedVariable& b) {
+        return bitwise(a, b, ::Xor);
+    }
+    static FixedVariable Add(const FixedVariable& a, const FixedVariable& b) {
+        return addition(a, b.bits, Circuit::getLiteralFalse(a.circuit));
+    }
+    static FixedVariable Sub(const FixedVariable& a, const FixedVariable& b) {
+        return addition(a, Not(b).bits, Circuit::getLiteralTrue(a.circuit));
+    }
+    static FixedVariable Mul(const FixedVariable& a, const FixedVariable& b) {
+        return FixedVariable(Variable::Mul_(a, b));
+    }
+    static FixedVariable Div(const FixedVariable& a, const FixedVariable& b) {
+        Variable q(a.circuit, getTypeInfo());
+        Variable::DivRem_(a, b, &q, nullptr);
+        return FixedVariable(q);
+    }
+    static FixedVariable Rem(const FixedVariable& a, const FixedVariable& b) {
+        Variable r(a.circuit, getTypeInfo());
+        Variable::DivRem_(a, b, nullptr, &r);
+        return FixedVariable(r);
+    }
+    static FixedVariable Shl(const FixedVariable& a, const FixedVariable& b) {
+        return barrel(a, b, Shl, FixedVariable(0, a.circuit));
+    }
+    static FixedVariable Shr(const FixedVariable& a, const FixedVariable& b) {
+        //out of range is Undefined Behavior; signed values give -1, as
+        //Variable's do
+        return barrel(a, b, Shr, FixedVariable(Signed ? -1 : 0, a.circuit));
+    }
+    static FixedVariable Shl(const FixedVariable& a, unsigned n) {
+        FixedVariable ret(a.circuit);
+        for (unsigned i = 0; i < N; ++i) {
+            ret.bits[i] = (i >= n) ? a.bits[i - n] : Circuit::getLiteralFalse(a.circuit);
+        }
+        return ret;
+    }
+    static FixedVariable Shr(const FixedVariable& a, unsigned n) {
+        auto fill = Signed ? a.bits[N-1] : Circuit::getLiteralFalse(a.circuit);
+        FixedVariable ret(a.circuit);
+        for (unsigned i = 0; i < N; ++i) {
+            ret.bits[i] = (i + n < N) ? a.bits[i + n] : fill;
+        }
+        return ret;
+    }
+    static FixedBit Equal(const FixedVariable& a, const FixedVariable& b) {
+        std::array<Circuit::Value, N> same;
+        for (unsigned i = 0; i < N; ++i) {
+            same[i] = ::Xnor(a.bits[i], b.bits[i]);
+        }
+        FixedBit ret(a.circuit);
+        ret.bits[0] = ::MultiAnd(same);
+        return ret;
+    }
+    static FixedBit Less(const FixedVariable& a, const FixedVariable& b) {
+        //a < b exactly when a + ~b + 1 does not carry out; flipping both
+        //sign bits maps signed order onto unsigned order
+        Bits x = a.bits;
+        Bits y = Not(b).bits;
+        if (Signed) {
+            x[N-1] = ::Not(x[N-1]);
+            y[N-1] = ::Not(y[N-1]);
+        }
+        Bits sum;
+        auto carry = AddBits(Circuit::getAdder(a.circuit), sum.data(), x.data(),
+                y.data(), N, Circuit::getLiteralTrue(a.circuit));
+        FixedBit ret(a.circuit);
+        ret.bits[0] = ::Not(carry);
+        return ret;
+    }
+    static FixedBit NotEq(const FixedVariable& a, const FixedVariable& b) {
+        return FixedBit::Not(Equal(a, b));
+    }
+    static FixedBit Greater(const FixedVariable& a, const FixedVariable& b) {
+        return Less(b, a);
+    }
+    static FixedBit LessEq(const FixedVariable& a, const FixedVariable& b) {
+        return FixedBit::Not(Less(b, a));
+    }
+    static FixedBit GreaterEq(const FixedVariable& a, const FixedVariable& b) {
+        return FixedBit::Not(Less(a, b));
+    }
+    static FixedBit LogAnd(const FixedVariable& a, const FixedVariable& b) {
+        return FixedBit::And(a.asBit(), b.asBit());
+    }
+    static FixedBit LogOr(const FixedVariable& a, const FixedVariable& b) {
+        return FixedBit::Or(a.asBit(), b.asBit());
+    }
+    //bitwise cond ? a : b
+    static FixedVariable Ternary(const FixedBit& cond, const FixedVariable& a,
+            const FixedVariable& b)
+    {
+        FixedVariable ret(a.circuit);
+        for (unsigned i = 0; i < N; ++i) {
+            ret.bits[i] = ::Or(::And(cond.bits[0], a.bits[i]),
+                    ::And(::Not(cond.bits[0]), b.bits[i]));
+        }
+        return ret;
+    }
+
+    FixedVariable operator~() const {
+        return Not(*this);
+    }
+    FixedVariable operator-() const {
+        return Sub(FixedVariable(0, circuit), *this);
+    }
+    FixedVariable operator+() const {
+        return *this;
+    }
+    FixedBit operator!() const {
+        return FixedBit::Not(asBit());
+    }
+    FixedVariable operator<<(unsigned n) const {
+        return Shl(*this, n);
+    }
+    FixedVariable operator>>(unsigned n) const {
+        return Shr(*this, n);
+    }
+private:
+    std::weak_ptr<Circuit::impl> circuit;
+    Bits bits;
+
+    explicit FixedVariable(const std::weak_ptr<Circuit::impl>& c) : circuit{c} {}
+    template <class Op>
+    static FixedVariable bitwise(const FixedVariable& a, const FixedVariable& b, Op op) {
+        FixedVariable ret(a.circuit);
+        for (unsigned i = 0; i < N; ++i) {
+            ret.bits[i] = op(a.bits[i], b.bits[i]);
+        }
+        return ret;
+    }
+    static FixedVariable addition(const FixedVariable& a, const Bits& b,
+            const Circuit::Value& carry)
+    {
+        FixedVariable ret(a.circuit);
+        AddBits(Circuit::getAdder(a.circuit), ret.bits.data(), a.bits.data(),
+                b.data(), N, carry);
+        return ret;
+    }
+    //bitwise c ? x : y
+    static FixedVariable select(const Circuit::Value& c, const FixedVariable& x,
+            const FixedVariable& y)
+    {
+        FixedVariable ret(x.circuit);
+        for (unsigned i = 0; i < N; ++i) {
+            if (x.bits[i].sameSource(y.bits[i])) {
+                ret.bits[i] = x.bits[i];
+            }
+            else {
+                ret.bits[i] = ::Or(::And(c, x.bits[i]), ::And(::Not(c), y.bits[i]));
+            }
+        }
+        return ret;
+    }
+    //a shifted by n, one stage for each bit of n below N; amounts of N or
+    //more (as unsigned) give out
+    static FixedVariable barrel(const FixedVariable& a, const FixedVariable& n,
+            FixedVariable (&op)(const FixedVariable&, unsigned), const FixedVariable& out)
+    {
+        FixedVariable ret = a;
+        for (unsigned k = 0; k < N && (1ull << k) < N; ++k) {
+            ret = select(n.bits[k], op(ret, 1u << k), ret);
+        }
+        typedef FixedVariable<N, false> Amount;
+        auto in_range = Amount::Less(n.template cast<N, false>(), Amount(N, a.circuit));
+        return select(in_range.bits[0], ret, out);
+    }
+};
+
+#define DEFINE_BINARY_OP(op, name, result) \
+    template <unsigned N, bool S, unsigned M, bool T> \
+    result operator op(const FixedVariable<N, S>& a, const FixedVariable<M, T>& b) { \
+        typedef typename FixedCommon<N, S, M, T>::type Common; \
+        return Common::name(a.template cast<Common::size(), Common::sign()>(), \
+                b.template cast<Common::size(), Common::sign()>()); \
+    } \
+    template <unsigned N, bool S, class Int, \
+             class = typename std::enable_if<is_integer<Int>::value>::type> \
+    auto operator op(const FixedVariable<N, S>& a, const Int& b) { \
+        return a op FixedFor<Int>(b, a.getCircuit()); \
+    } \
+    template <unsigned N, bool S, class Int, \
+             class = typename std::enable_if<is_integer<Int>::value>::type> \
+    auto operator op(const Int& a, const FixedVariable<N, S>& b) { \
+        return FixedFor<Int>(a, b.getCircuit()) op b; \
+    }
+
+#define ARITH typename FixedCommon<N, S, M, T>::type
+
+DEFINE_BINARY_OP(+, Add, ARITH);
+DEFINE_BINARY_OP(-, Sub, ARITH);
+DEFINE_BINARY_OP(*, Mul, ARITH);
+DEFINE_BINARY_OP(/, Div, ARITH);
+DEFINE_BINARY_OP(%, Rem, ARITH);
+DEFINE_BINARY_OP(<<, Shl, ARITH);
+DEFINE_BINARY_OP(>>, Shr, ARITH);
+DEFINE_BINARY_OP(&, And, ARITH);
+DEFINE_BINARY_OP(|, Or, ARITH);
+DEFINE_BINARY_OP(^, Xor, ARITH);
+DEFINE_BINARY_OP(==, Equal, FixedBit);
+DEFINE_BINARY_OP(<, Less, FixedBit);
+DEFINE_BINARY_OP(!=, NotEq, FixedBit);
+DEFINE_BINARY_OP(>, Greater, FixedBit);
+DEFINE_BINARY_OP(<=, LessEq, FixedBit);
+DEFINE_BINARY_OP(>=, GreaterEq, FixedBit);
+DEFINE_BINARY_OP(&&, LogAnd, FixedBit);
+DEFINE_BINARY_OP(||, LogOr, FixedBit);
+
+#undef ARITH
+#undef DEFINE_BINARY_OP
+
+#endif
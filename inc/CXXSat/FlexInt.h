@@ -11,6 +11,7 @@
 #include <CXXSat/TypeInfo.h>
 #include <CXXSat/IntegerTypes.h>
 #include <CXXSat/CastMode.h>
+#include <CXXSat/WideInt.h>
 
 class Variable;
 
@@ -105,13 +106,24 @@ private:
             }
         }
     } storage;
+    //anything wider than 64 bits lives here instead
+    WideInt wide;
     TypeInfo type;
+    static bool isWide(TypeInfo info) {
+        return info.size() > 64;
+    }
     template <class Op>
     auto do_t(Op op) {
+        if (isWide(type)) {
+            return op(wide);
+        }
         return storage.do_t(type, op);
     }
     template <class Op>
     auto do_t(Op op) const {
+        if (isWide(type)) {
+            return op(wide);
+        }
         return storage.do_t(type, op);
     }
     //It's Lambda-Ception!
@@ -162,15 +174,24 @@ public:
     FlexInt(const FlexInt&) = default;
     template <class Int>
     FlexInt(const Int& i) : FlexInt(i, TypeInfo::create<Int>()) {}
+    FlexInt(const WideInt& i) : FlexInt(i, i.getTypeInfo()) {}
     template <class Int>
     FlexInt(const Int& i, TypeInfo info) : type{info} {
-        do_t([i](auto& x) { x = i; });
+        if (isWide(info)) {
+            wide = WideInt(i, info);
+        }
+        else {
+            do_t([i](auto& x) { x = static_cast<std::decay_t<decltype(x)>>(i); });
+        }
     }
     FlexInt& operator=(const FlexInt&) = default;
     TypeInfo getTypeInfo() const {
         return type;
     }
     FlexInt cast(TypeInfo info) const {
+        if (isWide(info)) {
+            return do_t([info](const auto& i) { return FlexInt{WideInt(i, info)}; });
+        }
         int size = info.size();
         //handle bit or any other nonstandard sizes
         //that we run across
@@ -267,7 +288,7 @@ public:
     template <class Int>
     Int as() const {
         Int i;
-        do_t([&i](const auto& x) { i = x; });
+        do_t([&i](const auto& x) { i = static_cast<Int>(x); });
         return i;
     }
     explicit operator bool() const {
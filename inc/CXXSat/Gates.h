@@ -2,6 +2,7 @@
 #define GATES_H_INC
 
 #include <CXXSat/Circuit.h>
+#include <CXXSat/SmallVector.h>
 #include <assert.h>
 
 template <class DerivedGate>
@@ -27,7 +28,16 @@ public:
         source->disconnect(this);
     }
     static std::shared_ptr<Circuit::Wire> create(const Circuit::Value&);
-    void emplaceCNF(Problem& p);
+    void emplaceCNF(ClauseSink& p);
+    unsigned numClauses() const {
+        return 0;
+    }
+    unsigned numInputs() const {
+        return 1;
+    }
+    const std::shared_ptr<Circuit::Wire>& getInput(unsigned) const {
+        return source;
+    }
     //DO NOT USE:
     NotGate(const Circuit::Value& _a) : GateBase<NotGate>(_a.getCircuit()) {
         source = _a.source();
@@ -63,6 +73,12 @@ public:
         a->disconnect(this);
         b->disconnect(this);
     }
+    unsigned numInputs() const {
+        return 2;
+    }
+    const std::shared_ptr<Circuit::Wire>& getInput(unsigned i) const {
+        return i ? b : a;
+    }
     template <class OtherGate>
     typename std::enable_if<std::is_base_of<BinaryGate, OtherGate>::value>::type
     /* void */ replaceWith() {
@@ -73,19 +89,22 @@ public:
     }
 };
 
-#define DECLARE_BINARY_GATE(name) \
+#define DECLARE_BINARY_GATE(name, clauses) \
     class name : public BinaryGate<name> { \
     public: \
-        void emplaceCNF(Problem& p); \
+        void emplaceCNF(ClauseSink& p); \
+        unsigned numClauses() const { \
+            return clauses; \
+        } \
         using BinaryGate<name>::BinaryGate; \
     }
 
-DECLARE_BINARY_GATE(AndGate);
-DECLARE_BINARY_GATE(NandGate);
-DECLARE_BINARY_GATE(OrGate);
-DECLARE_BINARY_GATE(NorGate);
-DECLARE_BINARY_GATE(XorGate);
-DECLARE_BINARY_GATE(XnorGate);
+DECLARE_BINARY_GATE(AndGate, 3);
+DECLARE_BINARY_GATE(NandGate, 3);
+DECLARE_BINARY_GATE(OrGate, 3);
+DECLARE_BINARY_GATE(NorGate, 3);
+DECLARE_BINARY_GATE(XorGate, 4);
+DECLARE_BINARY_GATE(XnorGate, 4);
 
 #undef DECLARE_BINARY_GATE
 
@@ -124,6 +143,12 @@ public:
             i->disconnect(this);
         }
     }
+    unsigned numInputs() const {
+        return inputs.size();
+    }
+    const std::shared_ptr<Circuit::Wire>& getInput(unsigned i) const {
+        return inputs[i];
+    }
 protected:
     std::vector<std::shared_ptr<Circuit::Wire>> inputs;
 };
@@ -131,12 +156,15 @@ protected:
 #define DECLARE_MULTI_GATE(name) \
     class name : public MultiGate<name> { \
     public: \
-        void emplaceCNF(Problem& p); \
+        void emplaceCNF(ClauseSink& p); \
+        unsigned numClauses() const; \
         using MultiGate<name>::MultiGate; \
     }
 
 DECLARE_MULTI_GATE(MultiAndGate);
 DECLARE_MULTI_GATE(MultiOrGate);
+//three inputs only - true if at least two are
+DECLARE_MULTI_GATE(MajorityGate);
 
 #undef DECLARE_MULTI_GATE
 
@@ -149,15 +177,41 @@ Circuit::Value Nor(const Circuit::Value&, const Circuit::Value&);
 Circuit::Value Xor(const Circuit::Value&, const Circuit::Value&);
 Circuit::Value Xnor(const Circuit::Value&, const Circuit::Value&);
 Circuit::Value Not(const Circuit::Value&);
+Circuit::Value Majority(const Circuit::Value&, const Circuit::Value&,
+        const Circuit::Value&);
+
+//Literal inputs are dropped (or decide the result outright); a gate is
+//only created if more than one input remains.
+template <bool Identity, class GateType, class Container>
+Circuit::Value MultiGateFold(const Container& values) {
+    assert(begin(values) != end(values));
+    SmallVector<Circuit::Value, 8> inputs;
+    for (const auto& v : values) {
+        if (!v.isLiteral()) {
+            inputs.push_back(v);
+        }
+        else if (v.literalValue() != Identity) {
+            return v;
+        }
+    }
+    if (inputs.empty()) {
+        const auto& c = begin(values)->getCircuit();
+        return Identity ? Circuit::getLiteralTrue(c) : Circuit::getLiteralFalse(c);
+    }
+    if (inputs.size() == 1) {
+        return inputs[0];
+    }
+    return Circuit::Value{GateType::create(inputs)};
+}
 
 template <class Container>
 Circuit::Value MultiAnd(const Container& values) {
-    return Circuit::Value{MultiAndGate::create(values)};
+    return MultiGateFold<true, MultiAndGate>(values);
 }
 
 template <class Container>
 Circuit::Value MultiOr(const Container& values) {
-    return Circuit::Value{MultiOrGate::create(values)};
+    return MultiGateFold<false, MultiOrGate>(values);
 }
 
 typedef std::pair<Circuit::Value, Circuit::Value> AdderResT;
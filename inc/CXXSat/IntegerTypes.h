@@ -60,4 +60,33 @@ struct IntegerType_t<false, 128> {
 template <bool Signed, unsigned N>
 using IntegerType = typename IntegerType_t<Signed, N>::type;
 
+//std::is_integral and std::is_signed only know about __int128 in GNU
+//modes, so use these wherever a 128 bit integer may turn up
+template <class T>
+struct is_integer : std::is_integral<T> {};
+template <class T>
+struct is_signed_integer : std::is_signed<T> {};
+#if defined __clang__ || defined __GNUC__
+template <>
+struct is_integer<__int128_t> : std::true_type {};
+template <>
+struct is_integer<__uint128_t> : std::true_type {};
+template <>
+struct is_signed_integer<__int128_t> : std::true_type {};
+template <>
+struct is_signed_integer<__uint128_t> : std::false_type {};
+#endif
+
+//bit n of an integer's two's complement representation
+template <class Int>
+bool testbit(const Int& i, unsigned n) {
+    return static_cast<bool>((i >> n) & 1);
+}
+
+//whether an integer's type is signed (WideInt carries its own)
+template <class Int>
+bool signedness(const Int&) {
+    return is_signed_integer<Int>::value;
+}
+
 #endif
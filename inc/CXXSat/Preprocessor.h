@@ -0,0 +1,94 @@
+#ifndef PREPROCESSOR_H_INC
+#define PREPROCESSOR_H_INC
+
+#include <CXXSat/Sat.h>
+
+#include <vector>
+#include <cstddef>
+
+//Simplifies a Problem before it is solved, in process or by an external
+//solver from the DIMACS.  Tseitin encodings are full of variables that
+//only connect one gate to the next, and most of them can be resolved
+//away.  In rounds, until nothing changes:
+//    unit propagation
+//    equivalent literal substitution (cycles of binary implications)
+//    subsumption and self-subsuming resolution
+//    failed literal probing
+//    bounded variable elimination (never adding clauses)
+//
+//Frozen variables (the arguments, usually) are never eliminated or
+//substituted away, so their values in a model of the simplified problem
+//are values of the original.  The other variables keep their numbers,
+//and reconstruct() works out values for the ones that were removed.
+class Preprocessor {
+public:
+    struct Stats {
+        unsigned fixed = 0;
+        unsigned substituted = 0;
+        unsigned eliminated = 0;
+        unsigned subsumed = 0;
+        unsigned strengthened = 0;
+        unsigned failed = 0;
+    };
+
+    explicit Preprocessor(const Problem&);
+    void freeze(int var);
+    void freeze(const std::vector<int>& vars);
+    //call once, after freezing
+    Problem simplify();
+    //extends a full (not projected) model of the simplified problem to
+    //one of the original
+    Solution reconstruct(const Solution&) const;
+    const Stats& stats() const {
+        return counts;
+    }
+private:
+    struct Removed {
+        //made true if the clause is false
+        int witness;
+        std::vector<int> clause;
+    };
+    unsigned n;
+    std::vector<std::vector<int>> clauses;
+    std::vector<bool> dead;
+    //clause indices by literal; may list clauses that have since died or
+    //lost the literal
+    std::vector<std::vector<unsigned>> occ;
+    //per variable: 1 true, -1 false, 0 unassigned
+    std::vector<signed char> vals;
+    std::vector<bool> frozen;
+    //eliminated or substituted
+    std::vector<bool> gone;
+    std::vector<int> trail;
+    std::size_t head = 0;
+    bool unsat = false;
+    bool simplified = false;
+    std::vector<Removed> stack;
+    Stats counts;
+
+    static unsigned index(int lit) {
+        return 2*(lit > 0 ? lit : -lit) + (lit < 0);
+    }
+    int value(int lit) const {
+        int v = vals[lit > 0 ? lit : -lit];
+        return (lit > 0) ? v : -v;
+    }
+    bool contains(unsigned c, int lit) const;
+    //the live clauses containing lit, with the stale entries dropped
+    const std::vector<unsigned>& occurrences(int lit);
+    void add(std::vector<int> clause);
+    void remove(unsigned c);
+    void assign(int lit);
+    bool propagate();
+    bool substitute();
+    bool subsume();
+    bool probe();
+    //true if assuming lit propagates to a conflict; effort counts the
+    //literals visited
+    bool failed(int lit, std::size_t& effort);
+    bool eliminate();
+    //adds the live clauses again, after their literals have changed
+    void rebuild();
+};
+
+#endif
@@ -4,51 +4,335 @@
 #include <vector>
 #include <string>
 #include <ostream>
-#include <unordered_map>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
 #include <memory>
+#include <functional>
+#include <iterator>
+#include <initializer_list>
+#include <cstddef>
+#include <mutex>
+#include <atomic>
 
 typedef std::vector<int> Clause;
 typedef std::initializer_list<int> Clause_list;
 class Solution;
+class SatBackend;
+class Argument;
 
-class Problem {
+//One clause of a Problem, as a range of literals in its storage.  Only
+//valid until the next clause is added.
+class ClauseView {
 private:
-    std::vector<Clause> clauses;
-    unsigned max_var = 0;
+    const int* lits;
+    std::size_t len;
+public:
+    typedef const int* iterator;
+    typedef const int* const_iterator;
+    ClauseView(const int* l, std::size_t n) : lits{l}, len{n} {}
+    const int* begin() const {
+        return lits;
+    }
+    const int* end() const {
+        return lits + len;
+    }
+    std::size_t size() const {
+        return len;
+    }
+    bool empty() const {
+        return len == 0;
+    }
+    int operator[](std::size_t i) const {
+        return lits[i];
+    }
+};
+
+//Bounds on how long a solve may take.  A solve that reaches one gives
+//up, and its Solution's status is UNKNOWN.  One SolveLimits can govern
+//any number of solves, on any threads, and cancel() stops all of them.
+class SolveLimits {
 public:
-    typedef std::vector<Clause>::iterator iterator;
-    typedef std::vector<Clause>::const_iterator const_iterator;
-    void addClause(Clause);
+    //conflicts and propagations each time a solver runs (each cube, for
+    //solveCubes, and each solution, for enumerate), negative for no limit
+    std::int64_t conflicts = -1;
+    std::int64_t propagations = -1;
+    //wall-clock seconds for each call that solves, 0 for no limit
+    double seconds = 0;
+    //bytes resident in the whole process, checked a few times a second;
+    //0 for no limit
+    std::size_t memory = 0;
+
+    SolveLimits() = default;
+    SolveLimits(const SolveLimits&) = delete;
+    SolveLimits& operator=(const SolveLimits&) = delete;
+    //Interrupts every solve running under these limits, and makes any
+    //started later give up at once.  Safe to call from any thread.
+    void cancel();
+    bool cancelled() const {
+        return stopped;
+    }
+
+    //Applies the limits to a backend while in scope, so the backend's
+    //solve() honours them.
+    class Guard {
+    public:
+        Guard(const SolveLimits&, SatBackend&);
+        Guard(const Guard&) = delete;
+        ~Guard();
+        //true once the time or memory limit has been reached, from then
+        //until the Guard goes; the backend is only interrupted once, so
+        //callers that solve again check this first
+        bool expired() const;
+    private:
+        class Watchdog;
+        const SolveLimits& limits;
+        SatBackend& backend;
+        std::unique_ptr<Watchdog> watchdog;
+    };
+private:
+    //the backends of the solves running under these limits
+    mutable std::mutex m;
+    mutable std::vector<SatBackend*> running;
+    std::atomic<bool> stopped{false};
+};
+
+//Where the gates' clauses go.  Problem collects them; DIMACSWriter
+//streams them out as they come.
+class ClauseSink {
+public:
+    virtual ~ClauseSink() = default;
+    virtual void addClause(const int* lits, std::size_t n) = 0;
+    void addClause(const Clause& c) {
+        addClause(c.data(), c.size());
+    }
     void addClause(Clause_list l) {
-        addClause(Clause(l));
+        addClause(l.begin(), l.size());
+    }
+};
+
+//The clauses are kept end to end in one array of literals, with a second
+//array of where each begins, so adding a clause allocates nothing once
+//the arrays have grown (or been reserved) to size.
+class Problem final : public ClauseSink {
+private:
+    std::vector<int> literals;
+    //clause i is literals[offsets[i]] up to literals[offsets[i+1]]
+    std::vector<std::size_t> offsets{0};
+    unsigned max_var = 0;
+    //the variables solutions keep, or empty for all of them
+    std::vector<int> projection;
+    //gives the backend every clause
+    void load(SatBackend&) const;
+public:
+    class const_iterator {
+        friend class Problem;
+        const Problem* p;
+        std::size_t i;
+        const_iterator(const Problem* p, std::size_t i) : p{p}, i{i} {}
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef ClauseView value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef void pointer;
+        typedef ClauseView reference;
+        const_iterator() : p{nullptr}, i{0} {}
+        ClauseView operator*() const {
+            return (*p)[i];
+        }
+        ClauseView operator[](std::ptrdiff_t n) const {
+            return (*p)[i + n];
+        }
+        const_iterator& operator++() {
+            ++i;
+            return *this;
+        }
+        const_iterator operator++(int) {
+            return const_iterator(p, i++);
+        }
+        const_iterator& operator--() {
+            --i;
+            return *this;
+        }
+        const_iterator operator--(int) {
+            return const_iterator(p, i--);
+        }
+        const_iterator& operator+=(std::ptrdiff_t n) {
+            i += n;
+            return *this;
+        }
+        const_iterator& operator-=(std::ptrdiff_t n) {
+            i -= n;
+            return *this;
+        }
+        const_iterator operator+(std::ptrdiff_t n) const {
+            return const_iterator(p, i + n);
+        }
+        const_iterator operator-(std::ptrdiff_t n) const {
+            return const_iterator(p, i - n);
+        }
+        std::ptrdiff_t operator-(const const_iterator& it) const {
+            return (std::ptrdiff_t)i - (std::ptrdiff_t)it.i;
+        }
+        bool operator==(const const_iterator& it) const {
+            return i == it.i;
+        }
+        bool operator!=(const const_iterator& it) const {
+            return i != it.i;
+        }
+        bool operator<(const const_iterator& it) const {
+            return i < it.i;
+        }
+    };
+    //clauses are read through views, so there is nothing to modify
+    typedef const_iterator iterator;
+
+    using ClauseSink::addClause;
+    void addClause(const int* lits, std::size_t n) override;
+    void addClause(ClauseView c) {
+        addClause(c.begin(), c.size());
+    }
+    //appends all of another problem's clauses
+    void append(const Problem&);
+    //room for this many more clauses and literals in all, for callers
+    //that know roughly how much they will add
+    void reserve(std::size_t clauses, std::size_t lits) {
+        offsets.reserve(offsets.size() + clauses);
+        literals.reserve(literals.size() + lits);
+    }
+    //makes variables 1 to n exist, whether or not a clause uses them
+    void addVariables(unsigned n) {
+        if (n > max_var) {
+            max_var = n;
+        }
+    }
+    unsigned numVars() const {
+        return max_var;
+    }
+    std::size_t numClauses() const {
+        return offsets.size() - 1;
+    }
+    std::size_t numLiterals() const {
+        return literals.size();
+    }
+    ClauseView operator[](std::size_t i) const {
+        return ClauseView(literals.data() + offsets[i], offsets[i+1] - offsets[i]);
     }
     std::string toDIMACS() const;
     void printDIMACS(std::ostream& o) const;
-    iterator begin();
-    const_iterator begin() const;
-    iterator end();
-    const_iterator end() const;
+    const_iterator begin() const {
+        return const_iterator(this, 0);
+    }
+    const_iterator end() const {
+        return const_iterator(this, numClauses());
+    }
+    //Solutions found from now on keep only these variables (such as
+    //Argument::variables), which saves building and storing the rest of
+    //a large model; empty to keep every variable again.
+    void project(std::vector<int> vars) {
+        std::sort(vars.begin(), vars.end());
+        vars.erase(std::unique(vars.begin(), vars.end()), vars.end());
+        projection = std::move(vars);
+    }
+    //with the default backend
     Solution solve(bool = false) const;
+    Solution solve(const SolveLimits&) const;
+    //the backend should be fresh, as it is given every clause
+    Solution solve(SatBackend&, bool = false) const;
+    Solution solve(SatBackend&, const SolveLimits&, bool = false) const;
+    //Races differently configured solvers on their own threads (0 for
+    //one per core) and returns the first answer, stopping the rest.  The
+    //backends named are used in turn, and copies of one are diversified;
+    //by default every thread uses the default backend.
+    Solution solveParallel(unsigned threads,
+            const std::vector<std::string>& backends = {},
+            const SolveLimits& = SolveLimits()) const;
+    //Cube and conquer: solves once for each assignment to the variables
+    //(best a few that decide the rest, such as Argument::topBits), on a
+    //pool of threads (0 for one per core) that each keep one incremental
+    //solver.  Stops at the first satisfiable cube.  progress, if given,
+    //is called with the number of cubes refuted so far and the total.
+    Solution solveCubes(const std::vector<int>& vars, unsigned threads,
+            const std::function<void(std::size_t, std::size_t)>& progress = {},
+            const SolveLimits& = SolveLimits()) const;
+    //Calls found with every distinct assignment to the variables that
+    //some solution has, each as a Solution projected onto them, until
+    //there are none left or limit (if not 0) have been found.  Each one
+    //is blocked with a clause over just those variables, so one
+    //incremental solver finds them all.  With more than one thread,
+    //cubes over the first few variables are enumerated in parallel, and
+    //found is called from one thread at a time.  Returns the number
+    //found.  A solve that gives up under limits loses the rest of its
+    //cube; complete, if given, is set to whether none did.
+    std::size_t enumerate(std::vector<int> vars, std::size_t limit,
+            const std::function<void(const Solution&)>& found, unsigned threads = 1,
+            const SolveLimits& = SolveLimits(), bool* complete = nullptr) const;
+    //every value of the arguments, as numbered by the last generateCNF
+    std::size_t enumerate(const std::vector<Argument>& args, std::size_t limit,
+            const std::function<void(const Solution&)>& found, unsigned threads = 1,
+            const SolveLimits& = SolveLimits(), bool* complete = nullptr) const;
 };
 
+//The values a satisfying assignment gives the variables, one bit each.
+//By default every variable of the problem is kept, indexed by number;
+//a projected solution keeps only the variables asked for.  An
+//unsatisfiable problem gives a Solution that converts to false, as does
+//one whose solve gave up; status() tells them apart.
 class Solution {
     friend class Problem;
+    friend class SolverSession;
+    friend class Preprocessor;
+public:
+    enum class Status : char {
+        SAT,
+        UNSAT,
+        UNKNOWN
+    };
 private:
-    typedef std::unordered_map<int, bool> varmap_t;
-    std::unique_ptr<varmap_t> varmap;
-    Solution(std::unique_ptr<varmap_t>&& a) : varmap(std::move(a)) {}
+    std::vector<std::uint64_t> bits;
+    //the variables kept, in order, if only some are; otherwise bit i-1
+    //is variable i
+    std::vector<int> vars;
+    std::size_t count = 0;
+    Status result = Status::UNSAT;
     Solution() = default;
+    explicit Solution(Status s) : result{s} {}
+    //variables 1 to n of the backend's model, or just those projected
+    //onto if there are any
+    static Solution model(const SatBackend&, unsigned n, const std::vector<int>& projection);
+    //where variable i is kept, or -1 if it is not
+    std::ptrdiff_t index(int i) const {
+        if (vars.empty()) {
+            return (i >= 1 && (std::size_t)i <= count) ? i - 1 : -1;
+        }
+        auto it = std::lower_bound(vars.begin(), vars.end(), i);
+        return (it != vars.end() && *it == i) ? it - vars.begin() : -1;
+    }
+    bool bit(std::size_t k) const {
+        return (bits[k / 64] >> (k % 64)) & 1;
+    }
 public:
-    Solution(const Solution&) = default;
-    Solution(Solution&&) = default;
+    //false for a variable not kept
     bool operator[](int i) const {
-        return (*varmap)[i];
+        auto k = index(i);
+        return k >= 0 && bit(k);
     }
     bool at(int i) const {
-        return varmap->at(i);
+        auto k = index(i);
+        if (k < 0) {
+            throw std::out_of_range("Variable " + std::to_string(i) + " not in solution");
+        }
+        return bit(k);
+    }
+    //the number of variables kept
+    std::size_t size() const {
+        return count;
+    }
+    Status status() const {
+        return result;
     }
     explicit operator bool() const {
-        return (bool)varmap;
+        return result == Status::SAT;
     }
 };
 
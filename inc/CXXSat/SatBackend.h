@@ -0,0 +1,59 @@
+#ifndef SATBACKEND_H_INC
+#define SATBACKEND_H_INC
+
+#include <memory>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+//The solver a Problem or SolverSession hands its clauses to, modelled on
+//the IPASIR interface most incremental solvers implement.  Literals are
+//DIMACS-style ints, and variables exist once a clause mentions them.
+//
+//Backends are made by name:
+//    "minisat"         the Minisat the library is linked against
+//    "ipasir:<path>"   any IPASIR solver built as a shared library
+//                      (CaDiCaL, Kissat, Glucose...), loaded at runtime
+class SatBackend {
+public:
+    //the values solve() returns, as in IPASIR
+    enum {
+        UNKNOWN = 0,
+        SAT = 10,
+        UNSAT = 20
+    };
+    virtual ~SatBackend() = default;
+    virtual std::string name() const = 0;
+    virtual void addClause(const int* lits, std::size_t n) = 0;
+    //assumed true for the next solve() only
+    virtual void assume(int lit) = 0;
+    virtual int solve() = 0;
+    //the variable's value in the model the last solve() found
+    virtual bool value(int var) const = 0;
+    virtual unsigned numVars() const = 0;
+    //stops the next solve() after this many conflicts; negative for no
+    //limit.  Backends that cannot count conflicts ignore it.
+    virtual void limitConflicts(std::int64_t) {}
+    //likewise for propagations
+    virtual void limitPropagations(std::int64_t) {}
+    //Makes a running solve() return UNKNOWN soon, or the next one if
+    //none is running.  Safe from any thread.
+    virtual void interrupt() = 0;
+    //forgets an interrupt that came after the solve it was meant for
+    virtual void clearInterrupt() = 0;
+    //Switches to the nth of a set of differing search settings (seeds,
+    //restarts, phase saving), so several copies of a backend make
+    //different choices.  0 is the backend's defaults.  Backends without
+    //such settings ignore it.
+    virtual void diversify(unsigned) {}
+
+    static std::unique_ptr<SatBackend> create(const std::string& name);
+    //the backend create() makes
+    static std::unique_ptr<SatBackend> create() {
+        return create(getDefault());
+    }
+    static const std::string& getDefault();
+    static void setDefault(const std::string& name);
+};
+
+#endif
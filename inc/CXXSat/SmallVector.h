@@ -0,0 +1,254 @@
+#ifndef SMALLVECTOR_H_INC
+#define SMALLVECTOR_H_INC
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <stddef.h>
+#include <assert.h>
+
+//A vector that keeps up to N elements inside the object itself and only
+//goes to the heap past that.  Most Variables are 64 bits or narrower, so
+//building and copying them this way never allocates.  Moving one that
+//fits inline moves the elements rather than a pointer.
+template <class T, unsigned N>
+class SmallVector {
+public:
+    typedef T value_type;
+    typedef T* iterator;
+    typedef const T* const_iterator;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+
+    SmallVector() : ptr(local()), len(0), cap(N) {}
+    explicit SmallVector(size_type n) : SmallVector() {
+        resize(n);
+    }
+    SmallVector(size_type n, const T& value) : SmallVector() {
+        resize(n, value);
+    }
+    SmallVector(std::initializer_list<T> values) : SmallVector(values.begin(), values.end()) {}
+    template <class It, class = typename std::enable_if<!std::is_integral<It>::value>::type>
+    SmallVector(It b, It e) : SmallVector() {
+        reserve(std::distance(b, e));
+        for (; b != e; ++b) {
+            push_back(*b);
+        }
+    }
+    SmallVector(const SmallVector& v) : SmallVector(v.begin(), v.end()) {}
+    SmallVector(SmallVector&& v) : SmallVector() {
+        steal(v);
+    }
+    SmallVector& operator=(const SmallVector& v) {
+        if (this != &v) {
+            //reuse the elements already here
+            unsigned common = std::min(len, v.len);
+            std::copy(v.begin(), v.begin() + common, begin());
+            if (len > v.len) {
+                shrink(v.len);
+            }
+            else {
+                reserve(v.len);
+                for (unsigned i = common; i < v.len; ++i) {
+                    push_back(v[i]);
+                }
+            }
+        }
+        return *this;
+    }
+    SmallVector& operator=(SmallVector&& v) {
+        if (this != &v) {
+            clear();
+            release();
+            steal(v);
+        }
+        return *this;
+    }
+    ~SmallVector() {
+        clear();
+        release();
+    }
+
+    size_type size() const {
+        return len;
+    }
+    bool empty() const {
+        return len == 0;
+    }
+    size_type capacity() const {
+        return cap;
+    }
+    T* data() {
+        return ptr;
+    }
+    const T* data() const {
+        return ptr;
+    }
+    T& operator[](size_type i) {
+        assert(i < len);
+        return ptr[i];
+    }
+    const T& operator[](size_type i) const {
+        assert(i < len);
+        return ptr[i];
+    }
+    iterator begin() {
+        return ptr;
+    }
+    iterator end() {
+        return ptr + len;
+    }
+    const_iterator begin() const {
+        return ptr;
+    }
+    const_iterator end() const {
+        return ptr + len;
+    }
+    T& front() {
+        return (*this)[0];
+    }
+    const T& front() const {
+        return (*this)[0];
+    }
+    T& back() {
+        return (*this)[len - 1];
+    }
+    const T& back() const {
+        return (*this)[len - 1];
+    }
+
+    void reserve(size_type n) {
+        if (n <= cap) {
+            return;
+        }
+        T* mem = static_cast<T*>(::operator new(n * sizeof(T)));
+        for (unsigned i = 0; i < len; ++i) {
+            new (mem + i) T(std::move(ptr[i]));
+            ptr[i].~T();
+        }
+        release();
+        ptr = mem;
+        cap = n;
+    }
+    void resize(size_type n) {
+        if (n < len) {
+            shrink(n);
+            return;
+        }
+        grow(n);
+        for (; len < n; ++len) {
+            new (ptr + len) T();
+        }
+    }
+    void resize(size_type n, const T& value) {
+        if (n < len) {
+            shrink(n);
+            return;
+        }
+        grow(n);
+        for (; len < n; ++len) {
+            new (ptr + len) T(value);
+        }
+    }
+    void push_back(const T& value) {
+        emplace_back(value);
+    }
+    void push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+    template <class... Args>
+    T& emplace_back(Args&&... args) {
+        if (len == cap) {
+            //the argument may live in this vector, so build it first
+            T tmp(std::forward<Args>(args)...);
+            grow(len + 1);
+            new (ptr + len) T(std::move(tmp));
+        }
+        else {
+            new (ptr + len) T(std::forward<Args>(args)...);
+        }
+        return ptr[len++];
+    }
+    void pop_back() {
+        assert(len > 0);
+        ptr[--len].~T();
+    }
+    void clear() {
+        shrink(0);
+    }
+private:
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type buffer[N];
+    T* ptr;
+    unsigned len;
+    unsigned cap;
+
+    T* local() {
+        return reinterpret_cast<T*>(buffer);
+    }
+    bool isLocal() const {
+        return ptr == reinterpret_cast<const T*>(buffer);
+    }
+    void grow(size_type n) {
+        if (n > cap) {
+            reserve(std::max<size_type>(n, 2*cap));
+        }
+    }
+    void shrink(size_type n) {
+        while (len > n) {
+            ptr[--len].~T();
+        }
+    }
+    //frees the heap buffer, if any; the elements must already be gone
+    void release() {
+        if (!isLocal()) {
+            ::operator delete(ptr);
+            ptr = local();
+            cap = N;
+        }
+    }
+    //precondition: this is empty and local
+    void steal(SmallVector& v) {
+        if (v.isLocal()) {
+            for (unsigned i = 0; i < v.len; ++i) {
+                new (ptr + i) T(std::move(v.ptr[i]));
+            }
+            len = v.len;
+            v.clear();
+        }
+        else {
+            ptr = v.ptr;
+            len = v.len;
+            cap = v.cap;
+            v.ptr = v.local();
+            v.len = 0;
+            v.cap = N;
+        }
+    }
+};
+
+//found by ADL from the unqualified begin()/end() calls used on containers
+template <class T, unsigned N>
+typename SmallVector<T, N>::iterator begin(SmallVector<T, N>& v) {
+    return v.begin();
+}
+
+template <class T, unsigned N>
+typename SmallVector<T, N>::iterator end(SmallVector<T, N>& v) {
+    return v.end();
+}
+
+template <class T, unsigned N>
+typename SmallVector<T, N>::const_iterator begin(const SmallVector<T, N>& v) {
+    return v.begin();
+}
+
+template <class T, unsigned N>
+typename SmallVector<T, N>::const_iterator end(const SmallVector<T, N>& v) {
+    return v.end();
+}
+
+#endif
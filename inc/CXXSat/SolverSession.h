@@ -0,0 +1,70 @@
+#ifndef SOLVERSESSION_H_INC
+#define SOLVERSESSION_H_INC
+
+#include <CXXSat/Circuit.h>
+#include <CXXSat/Sat.h>
+#include <CXXSat/SatBackend.h>
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstddef>
+
+//A solver kept alive across queries on one circuit.  Each query adds only
+//the clauses of gates the solver has not seen yet, and what the solver
+//learned answering earlier queries carries over, so asking about many
+//targets (or one target under many assumptions) is much cheaper than
+//generating and solving a Problem for each.
+//
+//Wire numbers belong to the session: it numbers each wire the first time
+//it reaches it and never renumbers, and it holds on to those wires so the
+//numbers stay meaningful.  generateCNF renumbers the circuit, so the
+//session restores its numbers before adding clauses and before returning
+//a Solution; decode a Solution before generating any other CNF from the
+//circuit.
+class SolverSession {
+public:
+    explicit SolverSession(const Circuit&,
+            std::unique_ptr<SatBackend> = SatBackend::create());
+    SolverSession(const SolverSession&) = delete;
+    SolverSession& operator=(const SolverSession&) = delete;
+    ~SolverSession();
+    //the literal that is true when the bit is (a multi-bit variable is
+    //true when nonzero), adding whatever clauses it depends on
+    int literal(const Variable&);
+    //from now on, every query requires the bit to be true
+    void require(const Variable&);
+    //solves with each literal assumed true for this query only
+    Solution solve(const std::vector<int>& assumptions = {},
+            const SolveLimits& = SolveLimits());
+    //solves with the bit assumed true for this query only
+    Solution solve(const Variable&, const SolveLimits& = SolveLimits());
+    unsigned numVars() const {
+        return next - 1;
+    }
+    std::size_t numClauses() const {
+        return clauses;
+    }
+private:
+    class Sink;
+    std::shared_ptr<Circuit::impl> circuit;
+    std::unique_ptr<SatBackend> solver;
+    //every wire reached, with its number (0 for inverting wires)
+    std::unordered_map<std::shared_ptr<Circuit::Wire>, int> ids;
+    std::unordered_set<const Circuit::Gate*> encoded;
+    int next = 1;
+    std::size_t clauses = 0;
+    //the circuit's numbering when all of this session's numbers were
+    //last in place
+    std::size_t numbered = 0;
+    int number(const std::shared_ptr<Circuit::Wire>&);
+    //puts the session's numbers back on its wires, and numbers any
+    //inputs created since the last call; nothing to do unless the
+    //circuit has been renumbered or has new inputs since
+    void restore();
+    void encode(const std::shared_ptr<Circuit::Wire>& target);
+    void addClause(const int* lits, std::size_t n);
+};
+
+#endif
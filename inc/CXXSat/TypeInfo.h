@@ -1,6 +1,8 @@
 #ifndef TYPEINFO_H_INC
 #define TYPEINFO_H_INC
 
+#include <CXXSat/IntegerTypes.h>
+
 #include <type_traits>
 #include <ostream>
 #include <string>
@@ -23,7 +25,7 @@ public:
     }
     template <class Int>
     static TypeInfo create(Int i = Int{}) {
-        return TypeInfo{std::is_signed<Int>::value, (int)::numbits(i)};
+        return TypeInfo{is_signed_integer<Int>::value, (int)::numbits(i)};
     }
     bool isBit() const {
         return info == 0;
@@ -8,6 +8,7 @@
 #include <CXXSat/Gates.h>
 #include <CXXSat/TypeInfo.h>
 #include <CXXSat/FlexInt.h>
+#include <CXXSat/BitView.h>
 
 #include <array>
 #include <memory>
@@ -17,11 +18,17 @@
 
 class Variable;
 
+//The operators turn integer operands into literals.  Anything that
+//converts to a Variable (an Argument, a FixedVariable) is converted
+//instead.
+template <class T>
+using enable_if_literal = typename std::enable_if<!std::is_convertible<T, Variable>::value>::type;
+
 #define DECLARE_BINARY_OP(op, name) \
     Variable operator op(const Variable&, const Variable&); \
-    template <class Int> \
+    template <class Int, class = enable_if_literal<Int>> \
     Variable operator op(const Variable&, const Int&); \
-    template <class Int> \
+    template <class Int, class = enable_if_literal<Int>> \
     Variable operator op(const Int&, const Variable&);
 
 DECLARE_BINARY_OP(+, Add);
@@ -47,9 +54,14 @@ DECLARE_BINARY_OP(>=, GreaterEq);
 
 class Variable {
     friend class Circuit;
+    friend class SolverSession;
+    template <unsigned, bool>
+    friend class FixedVariable;
+public:
+    struct Comparison;
 private:
     std::weak_ptr<Circuit::impl> circuit;
-    std::vector<Circuit::Value> bits;
+    BitVector bits;
     bool is_signed;
     enum class op_t {
         arith,
@@ -84,13 +96,13 @@ private:
     static Variable Shl_(const Variable&, const Variable&);
     static Variable Shr_(const Variable&, const Variable&);
     static Variable Mul_full_(const Variable&, const Variable&);
-    static Variable Mul_(const Variable& a, const Variable& b) {
-        return Mul_full(a, b).cast(a.getTypeInfo()); //implicitly truncate
-    }
+    static Variable Mul_(const Variable&, const Variable&);
     static void DivRem_(const Variable&, const Variable&, Variable*, Variable*);
     //Comparisons
     static Variable Less_(const Variable&, const Variable&);
     static Variable Equal_(const Variable&, const Variable&);
+    static Comparison Compare_(const Variable&, const Variable&);
+    static Variable Sum_(const std::vector<Variable>&);
     //Ternary operator
     static Variable Ternary_(const Variable&, const Variable&, const Variable&);
     static const binary_operation_generic<Variable, const Variable&>::
@@ -108,6 +120,17 @@ public:
     bool isBit() const {
         return bits.size() == 1;
     }
+    //true if every bit is wired to a literal
+    bool isConstant() const;
+    //What the bits themselves say about the value: literal bits are
+    //known, and a bit driven by the same wire as the one below it (as
+    //extension leaves them) is known to equal it.  The operators keep
+    //these facts intact, and use them to build narrower circuits.
+    //
+    //the fewest low bits that give the value when zero extended
+    unsigned unsignedWidth() const;
+    //the fewest low bits that give the value when sign extended
+    unsigned signedWidth() const;
     TypeInfo getTypeInfo() const {
         if (isBit()) {
             return TypeInfo::createBit();
@@ -122,6 +145,8 @@ public:
     explicit Variable(const Circuit::Value& v) : circuit{v.getCircuit()}, bits{v}, is_signed{false} {}
     template <class Int>
     Variable(Int i, const std::weak_ptr<Circuit::impl>& c) : Variable(i, c, TypeInfo::create<Int>(i)) {}
+    Variable(const WideInt& i, const std::weak_ptr<Circuit::impl>& c) : Variable(i, c, i.getTypeInfo()) {}
+    Variable(const FlexInt& i, const std::weak_ptr<Circuit::impl>& c) : Variable(getLiteral(i, c)) {}
     template <class Int>
     Variable(Int, const std::weak_ptr<Circuit::impl>&, TypeInfo);
     //provide factory method to allow explicitly passing template param.
@@ -146,6 +171,9 @@ public:
         is_signed = v.is_signed;
         bits = std::move(v.bits);
     }
+    //the type operands of these types are converted to by the usual
+    //arithmetic conversions (and promotion, in C_STYLE)
+    static TypeInfo converted(TypeInfo, TypeInfo);
     //Begin operations
     static Variable MultiOr(const std::vector<Variable>&);
     static Variable MultiAnd(const std::vector<Variable>&);
@@ -155,6 +183,19 @@ public:
         return zero - a;
     }
     static Variable Not(const Variable&);
+    //Bit manipulation, as the GCC builtins.  Results have the operand's
+    //type, and Clz and Ctz of zero give the width instead of being
+    //undefined.  Constant rotates only rewire bits; other amounts are
+    //taken modulo the width (as unsigned) and go through a barrel shifter.
+    static Variable Popcount(const Variable&);
+    static Variable Clz(const Variable&);
+    static Variable Ctz(const Variable&);
+    //the width must be a whole number of bytes
+    static Variable Bswap(const Variable&);
+    static Variable Rotl(const Variable&, unsigned);
+    static Variable Rotl(const Variable&, const Variable&);
+    static Variable Rotr(const Variable&, unsigned);
+    static Variable Rotr(const Variable&, const Variable&);
     static Variable Minus(const Variable& a) {
         return Promote(Negative(a));
     }
@@ -198,6 +239,9 @@ public:
         DivRem(d, v, nullptr, &x);
         return std::move(x);
     }
+    //a + b + c + ..., with the conversions of a chain of Adds, but built
+    //as a carry-save tree finished by a single carry-propagate adder
+    static Variable Sum(const std::vector<Variable>&);
     static Variable Inc(const Variable& i) {
         return Add(i, i.getLiteral(FlexInt{1, i.getTypeInfo()}));
     }
@@ -216,14 +260,9 @@ public:
     static Variable Equal(const Variable& a, const Variable& b) {
         return Equal_proxy(a, b);
     }
-    /* Not worth the trouble...
-    template <class Int>
-    static Variable Equal(const Variable&, Int);
-    template <class Int>
-    static Variable NotEq(const Variable& v, Int i) {
-        return !Equal(v, i);
-    }
-    */
+    //for when more than one relation between the same operands is needed
+    static const binary_operation_generic<Comparison>::
+        binary_operation_t<Compare_, op_t::comp> Compare;
     static Variable NotEq(const Variable&, const Variable&);
     //Logical Operations
     static Variable LogAnd(const Variable& a, const Variable& b) {
@@ -243,7 +282,7 @@ public:
     }
     Variable abs() const {
         if (is_signed) {
-            return Ternary(bits[size()-1], Negative(*this), *this);
+            return negate_if(*this, bits[size()-1]);
         }
         else {
             return *this;
@@ -350,18 +389,102 @@ public:
         }
     }
     Variable cast(TypeInfo) const;
+    //the bits, least significant first, for slicing without copying
+    BitView view() const {
+        return bits;
+    }
+    //bits [lo, hi) as an unsigned value
+    Variable extract(unsigned lo, unsigned hi) const;
+    //lo in the low bits and hi above them, as an unsigned value
+    static Variable Concat(const Variable& lo, const Variable& hi);
 private:
     static Variable mask_all(const Variable&, const Variable&);
+    //bitwise a ? b : c, without Ternary's conversions
+    static Variable select(const Circuit::Value&, const Variable&, const Variable&);
+    //applies op by 2^k wherever bit k of the amount is set, for as many
+    //bits as the width needs
+    static Variable barrel(const Variable&, const Variable&,
+            Variable (&op)(const Variable&, unsigned));
     template <class Op>
     void binary_transform(const Variable&, const Variable&, Op);
     template <class Op>
     void variadic_transform(const std::vector<Variable>&, Op);
+    //true if bit i repeats bit i-1
+    bool repeats(unsigned i) const {
+        if (i == 0) {
+            return false;
+        }
+        const auto& a = bits[i];
+        const auto& b = bits[i-1];
+        return a.sameSource(b) ||
+            (a.isLiteral() && b.isLiteral() && a.literalValue() == b.literalValue());
+    }
+    //The narrowest type holding the values of both operands with extra
+    //bits of headroom; its sign says whether they are zero or sign
+    //extended to the operands' width (always zero for unsigned operands).
+    //The operands' own type if nothing narrower does.
+    static TypeInfo narrowest(const Variable&, const Variable&, unsigned extra);
+    //the same, given the widest operands' widths
+    static TypeInfo narrowest(unsigned unsigned_width, unsigned signed_width,
+            unsigned extra, TypeInfo own);
+    //compares the bounds the known bits give, or returns false if they
+    //leave the answer open
+    static bool known_less(const Variable&, const Variable&, bool& result);
+    static Circuit::Value less_than(const Variable&, const Variable&);
     static Variable do_addition(const Variable&, const Variable&, bool, 
             Circuit::Value* = nullptr);
+    static Variable do_addition(const Variable&, const Variable&,
+            const Circuit::Value&, Circuit::Value* = nullptr);
+    static Variable negate_if(const Variable&, const Circuit::Value&);
     static void divrem_unsigned(const Variable&, const Variable&, Variable*, Variable*);
-    static Variable mul_unsigned(const Variable&, const Variable&);
+    static void divrem_restoring(const Variable&, const Variable&, Variable*, Variable*);
+    static void divrem_nonrestoring(const Variable&, const Variable&, Variable*, Variable*);
+    //the low width bits of the product, for width n (truncated) or 2n (full)
+    static Variable mul_array(const Variable&, const Variable&, unsigned width);
+    //Specializations for operands that are known at circuit construction
+    std::vector<bool> constant_bits() const;
+    static Variable mul_constant(const Variable&, const std::vector<bool>&);
+    static void divrem_constant(const Variable&, const std::vector<bool>&,
+            Variable*, Variable*);
+    //Word-level constant folding: when both converted operands are
+    //constant, the proxies compute the result with FlexInt instead of
+    //building a circuit for it.  Only widths FlexInt represents exactly
+    //fold, and nothing the host can't compute (division by zero,
+    //INT_MIN / -1, out of range shifts) - those still build the circuit.
+    static bool foldable(TypeInfo);
+    FlexInt constant_value() const;
+    static bool foldable(Variable (&)(const Variable&, const Variable&),
+            const FlexInt&, const FlexInt&);
+    static Variable fold(Variable (&)(const Variable&, const Variable&),
+            const FlexInt&, const FlexInt&, const std::weak_ptr<Circuit::impl>&);
+    static bool foldable(Comparison (&)(const Variable&, const Variable&),
+            const FlexInt&, const FlexInt&);
+    static Comparison fold(Comparison (&)(const Variable&, const Variable&),
+            const FlexInt&, const FlexInt&, const std::weak_ptr<Circuit::impl>&);
+    static bool foldable(void (&)(const Variable&, const Variable&, Variable*, Variable*),
+            const FlexInt&, const FlexInt&, Variable*, Variable*);
+    static void fold(void (&)(const Variable&, const Variable&, Variable*, Variable*),
+            const FlexInt&, const FlexInt&, const std::weak_ptr<Circuit::impl>&,
+            Variable*, Variable*);
+    static bool foldable(Variable (&)(const Variable&, const Variable&, const Variable&),
+            const FlexInt&, const FlexInt&, const Variable&);
+    static Variable fold(Variable (&)(const Variable&, const Variable&, const Variable&),
+            const FlexInt&, const FlexInt&, const std::weak_ptr<Circuit::impl>&,
+            const Variable&);
     Variable(const std::weak_ptr<Circuit::impl>& c, TypeInfo info) :
-        circuit{c}, bits{(size_t)info.size()}, is_signed{info.sign()} {}
+        circuit{c}, bits((size_t)info.size()), is_signed{info.sign()} {}
+    Variable(const std::weak_ptr<Circuit::impl>& c, const BitView& v, bool sign) :
+        circuit{c}, is_signed{sign}
+    {
+        v.appendTo(bits);
+    }
+};
+
+//each member is a single bit
+struct Variable::Comparison {
+    Variable lt;
+    Variable eq;
+    Variable gt;
 };
 
 template <class Int>
@@ -371,17 +494,17 @@ Variable::Variable(Int t, const std::weak_ptr<Circuit::impl>& c, TypeInfo info)
     auto numbits = ::numbits(t);
     if (size() < numbits) {
         for (unsigned i = 0; i < size(); ++i) {
-            bits[i] = ((t >> i) & 1) ? Circuit::getLiteralTrue(c) : Circuit::getLiteralFalse(c);
+            bits[i] = testbit(t, i) ? Circuit::getLiteralTrue(c) : Circuit::getLiteralFalse(c);
         }
     }
     else {
         unsigned i;
         for (i = 0; i < numbits; ++i) {
-            bits[i] = ((t >> i) & 1) ? Circuit::getLiteralTrue(c) : Circuit::getLiteralFalse(c);
+            bits[i] = testbit(t, i) ? Circuit::getLiteralTrue(c) : Circuit::getLiteralFalse(c);
         }
         for (; i < size(); ++i) {
-            if (sign()) {
-                bits[i] = ((t >> (numbits - 1)) & 1) ? Circuit::getLiteralTrue(c) : Circuit::getLiteralFalse(c);
+            if (signedness(t)) {
+                bits[i] = testbit(t, numbits - 1) ? Circuit::getLiteralTrue(c) : Circuit::getLiteralFalse(c);
             }
             else {
                 bits[i] = Circuit::getLiteralFalse(this->getCircuit());
@@ -404,35 +527,31 @@ operator()(const Variable& a, const Variable& b, ExtraArgs... args) const {
         return Op(a, b, args...);
     }
     //otherwise, we have to perform the "usual arithmatic conversions"
-    unsigned op_size = std::max(a.size(), b.size());
-    bool op_sign;
-    if (a.sign() == b.sign()) {
-        op_sign = a.sign();
-    }
-    else {
-        //signedness differs
-        if (a.size() == b.size()) {
-            op_sign = false; //unsigned prevails if sizes equal
-        }
-        else {
-            op_sign = ((a.size() > b.size()) ? a : b).sign();
-        }
-    }
-    //however, all of that said:
-    if (CastMode::get() == CastMode::C_STYLE && op_size < int_size) {
-        //all values are converted to int
-        op_size = int_size;
-        op_sign = true;
-    }
-    auto info = TypeInfo(op_sign, op_size);
+    auto info = converted(a.getTypeInfo(), b.getTypeInfo());
     const auto& new_a = (a.getTypeInfo() == info) ? a : a.cast(info);
     const auto& new_b = (b.getTypeInfo() == info) ? b : b.cast(info);
+    if (foldable(info) && new_a.isConstant() && new_b.isConstant()) {
+        auto x = new_a.constant_value();
+        auto y = new_b.constant_value();
+        if (foldable(Op, x, y, args...)) {
+            return fold(Op, x, y, new_a.getCircuit(), args...);
+        }
+    }
     return Op(new_a, new_b, args...);
 }
 
 template <class Op>
 void Variable::binary_transform(const Variable& a, const Variable& b, Op op) {
-    std::transform(begin(a.bits), end(a.bits), begin(b.bits), begin(bits), op);
+    for (unsigned i = 0; i < size(); ++i) {
+        //an operation on repeated bits repeats its result, so extended
+        //operands give an extended result
+        if (a.repeats(i) && b.repeats(i)) {
+            bits[i] = bits[i-1];
+        }
+        else {
+            bits[i] = op(a.bits[i], b.bits[i]);
+        }
+    }
 }
 
 template <class Op>
@@ -447,45 +566,12 @@ void Variable::variadic_transform(const std::vector<Variable>& vec, Op op) {
     }
 }
 
-/* Not worth the trouble...
-template <class Int>
-Variable Variable::Equal(const Variable& a, Int b) {
-    if (::numbits(b) > a.size()) {
-        auto shiftout = b >> a.size();
-        if (shiftout != 0 || shiftout != (Int)-1) {
-            //we're too big - no way we can be equal
-            return Variable(Circuit::getLiteralFalse(a.getCircuit()));
-        }
-    }
-    auto numbits = std::min(a.size(), ::numbits(b));
-    auto bits = std::vector<Circuit::Value>{a.size()};
-    unsigned i;
-    for (i = 0; i < numbits; ++i) {
-        if (!((b >> i) & 1)) {
-            bits[i] = ::Not(a.bits[i]);
-        }
-        else {
-            bits[i] = a.bits[i];
-        }
-    }
-    for (; i < a.size(); ++i) {
-        if (a.sign()) {
-            bits[i] = ::Xnor(a.bits[i], a.bits[numbits-1]);
-        }
-        else {
-            bits[i] = ::Not(a.bits[i]);
-        }
-    }
-    return Variable(::MultiAnd(bits));
-}
-*/
-
 #define DEFINE_BINARY_OP(op, name) \
-    template <class Int> \
+    template <class Int, class> \
     Variable operator op(const Variable& a, const Int& b) { \
         return Variable::name(a, a.getLiteral(b)); \
     } \
-    template <class Int> \
+    template <class Int, class> \
     Variable operator op(const Int& a, const Variable& b) { \
         return Variable::name(b.getLiteral(a), b); \
     }
@@ -511,11 +597,11 @@ DEFINE_BINARY_OP(>=, GreaterEq);
 
 //For << and >> we don't want to clobber the unsigned overload:
 
-template <class Int>
+template <class Int, class>
 Variable operator <<(const Int& a, const Variable& b) {
     return Variable::Shl(b.getLiteral(a), b);
 }
-template <class Int>
+template <class Int, class>
 Variable operator >>(const Int& a, const Variable& b) {
     return Variable::Shr(b.getLiteral(a), b);
 }
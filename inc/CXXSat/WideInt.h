@@ -0,0 +1,131 @@
+#ifndef WIDEINT_H_INC
+#define WIDEINT_H_INC
+
+#include <CXXSat/TypeInfo.h>
+#include <CXXSat/IntegerTypes.h>
+
+#include <vector>
+#include <istream>
+#include <ostream>
+#include <type_traits>
+#include <stdint.h>
+
+//Two's complement integer of any width, used by FlexInt for anything
+//wider than 64 bits.  Arithmetic wraps modulo 2^size() like the native
+//unsigned types (and like the circuit does for signed ones).  Binary
+//operators expect operands of the same type, as FlexInt converts them
+//first; native integers convert implicitly at their own width.
+class WideInt {
+private:
+    TypeInfo type;
+    //least significant first; bits above size() are kept clear
+    std::vector<uint32_t> limbs;
+    void normalize();
+    //32 bits starting at bit 32*k, sign extended past the top
+    uint32_t word(unsigned k) const;
+    unsigned words() const {
+        return (size() + 31)/32;
+    }
+#if defined __clang__ || defined __GNUC__
+    typedef __uint128_t widest_t;
+#else
+    typedef uintmax_t widest_t;
+#endif
+public:
+    //zero of the given type
+    explicit WideInt(TypeInfo info) : type{info}, limbs((info.size() + 31)/32) {}
+    //placeholder for FlexInt's narrow values; doesn't allocate
+    WideInt() : type{TypeInfo::createBit()} {}
+    WideInt(const WideInt&) = default;
+    WideInt(WideInt&&) = default;
+    //converts the value like a C cast
+    WideInt(const WideInt&, TypeInfo);
+    template <class Int, class = typename std::enable_if<is_integer<Int>::value>::type>
+    WideInt(const Int& i) : WideInt(i, TypeInfo::create<Int>()) {}
+    template <class Int, class = typename std::enable_if<is_integer<Int>::value>::type>
+    WideInt(const Int& i, TypeInfo info) : WideInt(info) {
+        bool negative = is_signed_integer<Int>::value && i < Int(0);
+        for (unsigned k = 0; k < limbs.size(); ++k) {
+            if (32*k < ::numbits(i)) {
+                limbs[k] = (uint32_t)(i >> (32*k));
+            }
+            else {
+                limbs[k] = negative ? ~(uint32_t)0 : 0;
+            }
+        }
+        normalize();
+    }
+    WideInt& operator=(const WideInt&) = default;
+    WideInt& operator=(WideInt&&) = default;
+
+    TypeInfo getTypeInfo() const {
+        return type;
+    }
+    unsigned size() const {
+        return type.size();
+    }
+    bool sign() const {
+        return type.sign();
+    }
+    bool testbit(unsigned n) const {
+        return n/32 < limbs.size() && ((limbs[n/32] >> (n % 32)) & 1);
+    }
+    bool negative() const {
+        return sign() && testbit(size() - 1);
+    }
+
+    //truncates (or extends) like a C cast
+    template <class Int, class = typename std::enable_if<is_integer<Int>::value>::type>
+    explicit operator Int() const {
+        widest_t x = 0;
+        for (unsigned k = 0; k*32 < ::numbits(Int{}) && k*32 < 8*sizeof(widest_t); ++k) {
+            x |= (widest_t)word(k) << (32*k);
+        }
+        return (Int)x;
+    }
+    explicit operator bool() const;
+
+    WideInt operator-() const;
+    WideInt operator~() const;
+    WideInt& operator++();
+    WideInt& operator--();
+
+    friend WideInt operator+(const WideInt&, const WideInt&);
+    friend WideInt operator-(const WideInt&, const WideInt&);
+    friend WideInt operator*(const WideInt&, const WideInt&);
+    friend WideInt operator/(const WideInt&, const WideInt&);
+    friend WideInt operator%(const WideInt&, const WideInt&);
+    friend WideInt operator<<(const WideInt&, const WideInt&);
+    friend WideInt operator>>(const WideInt&, const WideInt&);
+    friend WideInt operator&(const WideInt&, const WideInt&);
+    friend WideInt operator|(const WideInt&, const WideInt&);
+    friend WideInt operator^(const WideInt&, const WideInt&);
+    friend bool operator<(const WideInt&, const WideInt&);
+    friend bool operator>(const WideInt&, const WideInt&);
+    friend bool operator<=(const WideInt&, const WideInt&);
+    friend bool operator>=(const WideInt&, const WideInt&);
+    friend bool operator==(const WideInt&, const WideInt&);
+    friend bool operator!=(const WideInt&, const WideInt&);
+    //honor the stream's basefield, like the native types
+    friend std::ostream& operator<<(std::ostream&, const WideInt&);
+    friend std::istream& operator>>(std::istream&, WideInt&);
+private:
+    //magnitude divided by a small divisor in place; returns the remainder
+    uint32_t divmod_small(uint32_t);
+    static void divmod(const WideInt&, const WideInt&, WideInt*, WideInt*);
+};
+
+template<>
+inline size_t numbits<WideInt>(WideInt i) {
+    return i.size();
+}
+
+inline bool testbit(const WideInt& i, unsigned n) {
+    return i.testbit(n);
+}
+
+inline bool signedness(const WideInt& i) {
+    return i.sign();
+}
+
+#endif
@@ -29,6 +29,9 @@ class VarRef {
         if (type == RVALUE) {
             storage.rvalue.~unique_ptr<Variable>();
         }
+        else if (type == INTEGER) {
+            storage.integer.~FlexInt();
+        }
     }
     template <class T>
     VarRef& assign_rvalue(T&& x) {
@@ -50,15 +53,24 @@ public:
             new (&storage.rvalue) std::unique_ptr<Variable>(new Variable(*(other.storage.rvalue)));
         }
         else if (type == INTEGER) {
-            storage.integer = other.storage.integer;
+            new (&storage.integer) FlexInt(other.storage.integer);
         }
         else if (type == LVALUE) {
             storage.lvalue = other.storage.lvalue;
         }
     }
     VarRef& operator=(const VarRef& other) {
-        if (type == INTEGER || other.type == INTEGER) {
-            storage.integer = other.storage.integer;
+        //FlexInt holds a WideInt, so switching members has to construct
+        //and destroy them properly
+        if (type != LVALUE && other.type == INTEGER) {
+            if (type == INTEGER) {
+                storage.integer = other.storage.integer;
+            }
+            else {
+                destroy();
+                new (&storage.integer) FlexInt(other.storage.integer);
+                type = INTEGER;
+            }
         }
         else {
             *this = other.asVariable();
@@ -67,6 +79,7 @@ public:
     }
     VarRef& operator=(const Variable& other) {
         if (type == INTEGER) {
+            destroy();
             type = RVALUE;
             new (&storage.rvalue) std::unique_ptr<Variable>(new Variable(other));
         }
@@ -94,7 +107,7 @@ public:
             new (&storage.rvalue) std::unique_ptr<Variable>(std::move(other.storage.rvalue));
         }
         else if (type == INTEGER) {
-            storage.integer = other.storage.integer;
+            new (&storage.integer) FlexInt(other.storage.integer);
         }
         else if (type == LVALUE) {
             storage.lvalue = other.storage.lvalue;
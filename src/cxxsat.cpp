@@ -11,6 +11,9 @@
 #include <llvm/Support/CommandLine.h>
 #include <functional>
 #include <iostream>
+#include <stdexcept>
+#include <system_error>
+#include <unistd.h>
 
 #include "FindFunction.h"
 #include "Scope.h"
@@ -18,6 +21,9 @@
 
 #include <CXXSat/Argument.h>
 #include <CXXSat/Circuit.h>
+#include <CXXSat/SatBackend.h>
+#include <CXXSat/SolverSession.h>
+#include <CXXSat/Preprocessor.h>
 #include <CXXSat/FlexInt.h>
 #include <CXXSat/TypeInfo.h>
 
@@ -44,6 +50,7 @@ VarRef parseBinaryOperator(clang::BinaryOperator*, clang::ASTContext*, Scope&);
 VarRef parseCast(clang::CastExpr*, clang::ASTContext*, Scope&);
 VarRef parseDeclRef(clang::DeclRefExpr*, clang::ASTContext*, Scope&);
 VarRef parseIntLiteral(clang::IntegerLiteral*, clang::ASTContext*, Scope&);
+VarRef parseCall(clang::CallExpr*, clang::ASTContext*, Scope&);
 
 bool parseStmt(clang::Stmt* stmt, clang::ASTContext* con, Scope& scope) {
     if (!stmt) return true;
@@ -131,6 +138,8 @@ VarRef parseExpr(clang::Expr* expr, clang::ASTContext* con, Scope& scope) {
             return parseIntLiteral((clang::IntegerLiteral*)expr, con, scope);
         case clang::Stmt::DeclRefExprClass:
             return parseDeclRef((clang::DeclRefExpr*)expr, con, scope);
+        case clang::Stmt::CallExprClass:
+            return parseCall((clang::CallExpr*)expr, con, scope);
         default:
             std::cerr << "Ignoring expression of type " << expr->getStmtClassName() << '\n';
             assert(false);
@@ -253,17 +262,54 @@ VarRef parseIntLiteral(clang::IntegerLiteral* expr, clang::ASTContext* con, Scop
     assert(type->isIntegerType());
     bool sign = type->isSignedIntegerType();
     unsigned size = con->getTypeInfo(type).second;
-    FlexInt x = sign ?
-        expr->getValue().getSExtValue() :
-        expr->getValue().getZExtValue();
     TypeInfo info{sign, (int)size};
-    return VarRef{scope, x.cast(info)};
+    //go through the decimal string, since the value may not fit 64 bits
+    return VarRef{scope, FlexInt::fromString(expr->getValue().toString(10, sign), info)};
 }
 
 VarRef parseDeclRef(clang::DeclRefExpr* expr, clang::ASTContext*, Scope& scope) {
     return scope[expr->getNameInfo().getAsString()];
 }
 
+//Only the bit manipulation builtins are supported.  Their arguments have
+//already been converted to the parameter types, so e.g. the l and ll
+//variants differ only in the width of the Variable they receive.
+VarRef parseCall(clang::CallExpr* expr, clang::ASTContext* con, Scope& scope) {
+    auto callee = expr->getDirectCallee();
+    auto name = callee ? callee->getNameAsString() : std::string{};
+    auto is = [&name](const std::string& prefix) {
+        return name.compare(0, prefix.size(), prefix) == 0;
+    };
+    std::vector<Variable> args;
+    for (unsigned i = 0; i < expr->getNumArgs(); ++i) {
+        args.push_back(parseExpr(expr->getArg(i), con, scope).asVariable());
+    }
+    auto type = expr->getType();
+    assert(type->isIntegerType());
+    TypeInfo info{type->isSignedIntegerType(), (int)con->getTypeInfo(type).second};
+    if (is("__builtin_popcount") && args.size() == 1) {
+        return VarRef::create_rvalue(scope, Variable::Popcount(args[0]).cast(info));
+    }
+    if (is("__builtin_clz") && args.size() == 1) {
+        return VarRef::create_rvalue(scope, Variable::Clz(args[0]).cast(info));
+    }
+    if (is("__builtin_ctz") && args.size() == 1) {
+        return VarRef::create_rvalue(scope, Variable::Ctz(args[0]).cast(info));
+    }
+    if (is("__builtin_bswap") && args.size() == 1) {
+        return VarRef::create_rvalue(scope, Variable::Bswap(args[0]).cast(info));
+    }
+    if (is("__builtin_rotateleft") && args.size() == 2) {
+        return VarRef::create_rvalue(scope, Variable::Rotl(args[0], args[1]).cast(info));
+    }
+    if (is("__builtin_rotateright") && args.size() == 2) {
+        return VarRef::create_rvalue(scope, Variable::Rotr(args[0], args[1]).cast(info));
+    }
+    std::cerr << "Ignoring call to " << (name.empty() ? "<indirect>" : name) << '\n';
+    assert(false);
+    throw 0;
+}
+
 struct parseFunc_res {
     Circuit circuit;
     Scope scope;
@@ -296,38 +342,131 @@ parseFunc_res parseFunc(clang::FunctionDecl* decl, clang::ASTContext* con) {
     return {std::move(c), std::move(scope), std::move(args), ti};
 }
 
-void satisfyFunc(clang::FunctionDecl* decl, clang::ASTContext* con, const std::string& retval_s, bool dump) {
+//false after reporting an error, such as output that could not be written
+bool satisfyFunc(clang::FunctionDecl* decl, clang::ASTContext* con, const std::vector<std::string>& values, bool dump, bool all, bool preprocess, unsigned jobs, const SolveLimits& limits) {
     auto res = parseFunc(decl, con);
-    auto retval_int = FlexInt::fromString(retval_s, res.return_type);
-    auto retval = VarRef{res.scope, retval_int};
-    auto p = res.circuit.generateCNF(res.scope.return_value() == retval);
+    auto target = [&](const std::string& retval_s) -> Variable {
+        auto retval_int = FlexInt::fromString(retval_s, res.return_type);
+        return res.scope.return_value() == VarRef{res.scope, retval_int};
+    };
+    //The arguments are frozen, so a model of the simplified problem gives
+    //them the same values as the original would, and they are all that is
+    //printed; nothing need be reconstructed.
+    auto problem = [&](const std::string& value) {
+        auto p = res.circuit.generateCNF(target(value));
+        if (!preprocess) {
+            return p;
+        }
+        Preprocessor pre(p);
+        for (auto& arg : res.args) {
+            pre.freeze(arg.second.variables());
+        }
+        return pre.simplify();
+    };
     if (dump) {
-        p.printDIMACS(std::cout);
+        if (values.size() != 1) {
+            std::cerr << "-dump takes a single -value\n";
+            return false;
+        }
+        if (preprocess) {
+            problem(values[0]).printDIMACS(std::cout);
+            if (!std::cout.flush()) {
+                std::cerr << "writing DIMACS failed\n";
+                return false;
+            }
+            return true;
+        }
+        //streamed, so huge problems never sit in memory
+        std::cout.flush();
+        try {
+            res.circuit.writeDIMACS(target(values[0]), STDOUT_FILENO);
+        }
+        catch (const std::system_error& e) {
+            std::cerr << e.what() << '\n';
+            return false;
+        }
+        return true;
     }
-    else {
-        auto soln = p.solve();
+    //one solver for every value, so the function is only encoded once
+    SolverSession session(res.circuit);
+    for (auto& value : values) {
+        if (values.size() > 1) {
+            std::cout << value << ":\n";
+        }
+        if (all) {
+            std::vector<Argument> args;
+            for (auto& arg : res.args) {
+                args.push_back(arg.second);
+            }
+            auto p = problem(value);
+            bool complete;
+            auto n = p.enumerate(args, 0, [&](const Solution& soln) {
+                for (auto& arg : res.args) {
+                    std::cout << arg.first << ' ' << arg.second.solution(soln) << '\n';
+                }
+                std::cout << '\n';
+            }, jobs, limits, &complete);
+            //some solutions may be missing
+            if (!complete) {
+                std::cout << "UNKNOWN\n";
+            }
+            else if (n == 0) {
+                std::cout << "UNSAT\n";
+            }
+            continue;
+        }
+        //a portfolio needs the whole problem for each solver, and a
+        //simplified one is made afresh for each value, so neither can
+        //share the session
+        auto soln = (jobs == 1 && !preprocess) ? session.solve(target(value), limits) :
+            (jobs == 1) ? problem(value).solve(limits) :
+            problem(value).solveParallel(jobs, {}, limits);
         if (soln) {
             for (auto& arg : res.args) {
                 std::cout << arg.first << ' ' << arg.second.solution(soln) << '\n';
             }
         }
+        else if (soln.status() == Solution::Status::UNKNOWN) {
+            std::cout << "UNKNOWN\n";
+        }
         else {
             std::cout << "UNSAT\n";
         }
     }
+    return true;
 }
 
 int main(int argc, const char **argv) {
     llvm::cl::OptionCategory cxxsat("cxxsat options");
     llvm::cl::extrahelp helpmsg(clang::tooling::CommonOptionsParser::HelpMessage);
     llvm::cl::opt<std::string> funcname("function", llvm::cl::Required, llvm::cl::desc("function to satisfy"), llvm::cl::cat(cxxsat));
-    llvm::cl::opt<std::string> value("value", llvm::cl::Required, llvm::cl::desc("desired return value of function"), llvm::cl::cat(cxxsat));
+    llvm::cl::list<std::string> values("value", llvm::cl::OneOrMore, llvm::cl::CommaSeparated, llvm::cl::desc("desired return value of function; several are solved in turn"), llvm::cl::cat(cxxsat));
     llvm::cl::opt<bool> dump("dump", llvm::cl::desc("Dump DIMACS output to stdout instead of solving"), llvm::cl::cat(cxxsat));
+    llvm::cl::opt<bool> all("all", llvm::cl::desc("Print every set of arguments giving the value, not just one"), llvm::cl::cat(cxxsat));
+    llvm::cl::opt<bool> preprocess("preprocess", llvm::cl::desc("Simplify the CNF (eliminating variables, keeping the arguments) before solving or dumping it"), llvm::cl::cat(cxxsat));
+    llvm::cl::opt<unsigned> jobs("j", llvm::cl::init(1), llvm::cl::desc("Solve on this many threads (0 for one per core): a portfolio of differently configured solvers, or with -all, separate cubes of the arguments"), llvm::cl::cat(cxxsat));
+    llvm::cl::opt<double> timeout("timeout", llvm::cl::init(0), llvm::cl::desc("Give up on a value after this many seconds (0 for never)"), llvm::cl::cat(cxxsat));
+    llvm::cl::opt<long long> conflicts("conflicts", llvm::cl::init(-1), llvm::cl::desc("Give up on a value after this many conflicts (with -all, for each set of arguments; -1 for never)"), llvm::cl::cat(cxxsat));
+    llvm::cl::opt<std::string> solver("solver", llvm::cl::init("minisat"), llvm::cl::desc("SAT backend: minisat, or ipasir:<path to solver library>"), llvm::cl::cat(cxxsat));
     clang::tooling::CommonOptionsParser opts(argc, argv, cxxsat);
+    SatBackend::setDefault(solver);
+    try {
+        //fail now rather than after parsing
+        SatBackend::create();
+    }
+    catch (const std::invalid_argument& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
     auto& compile = opts.getCompilations();
     clang::tooling::ClangTool tool(compile, opts.getSourcePathList());
-    FindFunctionFactory factory(funcname.c_str(), [&value, &dump](clang::FunctionDecl* d, clang::ASTContext* con) {
-            satisfyFunc(d, con, value, dump); });
+    std::vector<std::string> value_list(values.begin(), values.end());
+    SolveLimits limits;
+    limits.seconds = timeout;
+    limits.conflicts = conflicts;
+    bool ok = true;
+    FindFunctionFactory factory(funcname.c_str(), [&](clang::FunctionDecl* d, clang::ASTContext* con) {
+            ok = satisfyFunc(d, con, value_list, dump, all, preprocess, jobs, limits) && ok; });
     int result = tool.run(&factory);
-    return 0;
+    return ok ? 0 : 1;
 }
@@ -0,0 +1,167 @@
+#include <CXXSat/Adders.h>
+#include <CXXSat/Gates.h>
+#include <CXXSat/SmallVector.h>
+
+#include <cmath>
+#include <algorithm>
+
+Circuit::Value RippleAdder(Circuit::Value* sum, const Circuit::Value* a,
+        const Circuit::Value* b, unsigned n, const Circuit::Value& carry_in)
+{
+    auto carry = carry_in;
+    for (unsigned i = 0; i < n; ++i) {
+        std::tie(sum[i], carry) = FullAdder(a[i], b[i], std::move(carry));
+    }
+    return carry;
+}
+
+Circuit::Value CarryLookaheadAdder(Circuit::Value* sum, const Circuit::Value* a,
+        const Circuit::Value* b, unsigned n, const Circuit::Value& carry_in)
+{
+    const unsigned group = 4;
+    auto carry = carry_in;
+    for (unsigned base = 0; base < n; base += group) {
+        unsigned top = std::min(base + group, n);
+        AdderBits g, p;
+        for (unsigned i = base; i < top; ++i) {
+            g.push_back(And(a[i], b[i]));
+            p.push_back(Xor(a[i], b[i]));
+        }
+        //c[i+1] = g[i] | p[i]g[i-1] | ... | p[i]...p[base]c[base], each
+        //carry computed directly from the group's carry in
+        Circuit::Value next;
+        for (unsigned i = 0; i < top - base; ++i) {
+            sum[base + i] = Xor(p[i], i ? next : carry);
+            AdderBits terms;
+            for (int k = i; k >= -1; --k) {
+                //generated at bit k (or the carry in, at k = -1) and
+                //propagated through every bit above it
+                AdderBits product(p.begin() + k + 1, p.begin() + i + 1);
+                product.push_back(k >= 0 ? g[k] : carry);
+                terms.push_back(MultiAnd(product));
+            }
+            next = MultiOr(terms);
+        }
+        carry = std::move(next);
+    }
+    return carry;
+}
+
+namespace {
+
+//(generate, propagate) for a span of bits
+typedef std::pair<Circuit::Value, Circuit::Value> Span;
+//the carry in and one per bit, inline up to 64 bits
+typedef SmallVector<Span, 65> Spans;
+
+//the span made by placing hi directly above lo
+Span combine(const Span& hi, const Span& lo) {
+    return {Or(hi.first, And(hi.second, lo.first)), And(hi.second, lo.second)};
+}
+
+//Element 0 of a prefix network is the carry in; element i+1 is bit i.
+//Once the prefix is complete, element i generates the carry into bit i.
+//The propagate bits are also kept in p for computing the sum.
+Spans prefixSpans(AdderBits& p, const Circuit::Value* a,
+        const Circuit::Value* b, unsigned n, const Circuit::Value& carry)
+{
+    Spans spans;
+    spans.reserve(n + 1);
+    spans.emplace_back(carry, Circuit::getLiteralFalse(carry.getCircuit()));
+    p.clear();
+    for (unsigned i = 0; i < n; ++i) {
+        p.push_back(Xor(a[i], b[i]));
+        spans.emplace_back(And(a[i], b[i]), p.back());
+    }
+    return spans;
+}
+
+Circuit::Value prefixSum(Circuit::Value* sum, const Spans& spans,
+        const AdderBits& p)
+{
+    for (unsigned i = 0; i < p.size(); ++i) {
+        sum[i] = Xor(p[i], spans[i].first);
+    }
+    return spans.back().first;
+}
+
+}
+
+Circuit::Value KoggeStoneAdder(Circuit::Value* sum, const Circuit::Value* a,
+        const Circuit::Value* b, unsigned n, const Circuit::Value& carry)
+{
+    AdderBits p;
+    auto spans = prefixSpans(p, a, b, n, carry);
+    for (unsigned d = 1; d < spans.size(); d *= 2) {
+        auto prev = spans;
+        for (unsigned i = d; i < spans.size(); ++i) {
+            spans[i] = combine(prev[i], prev[i - d]);
+        }
+    }
+    return prefixSum(sum, spans, p);
+}
+
+Circuit::Value BrentKungAdder(Circuit::Value* sum, const Circuit::Value* a,
+        const Circuit::Value* b, unsigned n, const Circuit::Value& carry)
+{
+    AdderBits p;
+    auto spans = prefixSpans(p, a, b, n, carry);
+    unsigned m = spans.size();
+    unsigned d;
+    //up-sweep: combine into every 2d-th element
+    for (d = 1; d < m; d *= 2) {
+        for (unsigned i = 2*d - 1; i < m; i += 2*d) {
+            spans[i] = combine(spans[i], spans[i - d]);
+        }
+    }
+    //down-sweep: fill in the elements between them
+    for (d /= 2; d > 0; d /= 2) {
+        for (unsigned i = 3*d - 1; i < m; i += 2*d) {
+            spans[i] = combine(spans[i], spans[i - d]);
+        }
+    }
+    return prefixSum(sum, spans, p);
+}
+
+Circuit::Value CarrySelectAdder(Circuit::Value* sum, const Circuit::Value* a,
+        const Circuit::Value* b, unsigned n, const Circuit::Value& carry_in)
+{
+    unsigned block = std::max(1u, (unsigned)std::lround(std::sqrt(n)));
+    auto lit0 = Circuit::getLiteralFalse(carry_in.getCircuit());
+    auto lit1 = Circuit::getLiteralTrue(carry_in.getCircuit());
+    auto carry = carry_in;
+    for (unsigned base = 0; base < n; base += block) {
+        unsigned len = std::min(base + block, n) - base;
+        if (base == 0) {
+            carry = RippleAdder(sum, a, b, len, carry);
+            continue;
+        }
+        AdderBits s0(len), s1(len);
+        auto c0 = RippleAdder(s0.data(), a + base, b + base, len, lit0);
+        auto c1 = RippleAdder(s1.data(), a + base, b + base, len, lit1);
+        for (unsigned i = 0; i < len; ++i) {
+            sum[base + i] = Or(And(carry, s1[i]), And(Not(carry), s0[i]));
+        }
+        //c1 is set whenever c0 is
+        carry = Or(c0, And(carry, c1));
+    }
+    return carry;
+}
+
+Circuit::Value AddBits(Circuit::Adder type, Circuit::Value* sum, const Circuit::Value* a,
+        const Circuit::Value* b, unsigned n, const Circuit::Value& carry)
+{
+    switch (type) {
+    case Circuit::Adder::CARRY_LOOKAHEAD:
+        return CarryLookaheadAdder(sum, a, b, n, carry);
+    case Circuit::Adder::KOGGE_STONE:
+        return KoggeStoneAdder(sum, a, b, n, carry);
+    case Circuit::Adder::BRENT_KUNG:
+        return BrentKungAdder(sum, a, b, n, carry);
+    case Circuit::Adder::CARRY_SELECT:
+        return CarrySelectAdder(sum, a, b, n, carry);
+    case Circuit::Adder::RIPPLE:
+    default:
+        return RippleAdder(sum, a, b, n, carry);
+    }
+}
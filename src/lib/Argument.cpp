@@ -27,6 +27,27 @@ FlexInt Argument::solution(const Solution& s) const {
     return t;
 }
 
+std::vector<int> Argument::variables() const {
+    std::vector<int> ret;
+    for (auto& input : inputs) {
+        if (int id = input->getID()) {
+            ret.push_back(id);
+        }
+    }
+    return ret;
+}
+
+std::vector<int> Argument::topBits(unsigned n) const {
+    std::vector<int> ret;
+    for (unsigned i = size(); i-- > 0 && ret.size() < n;) {
+        int id = inputs[i]->getID();
+        if (id != 0) {
+            ret.push_back(id);
+        }
+    }
+    return ret;
+}
+
 void Argument::print(std::ostream& o, const Solution& s) const {
     o << +solution(s);
 }
@@ -0,0 +1,84 @@
+#include <CXXSat/BitView.h>
+
+BitView::BitView(const Circuit::Value* bits, unsigned n) {
+    append({bits, n, {}});
+}
+
+BitView BitView::fill(const Circuit::Value& bit, unsigned n) {
+    BitView ret;
+    ret.append({nullptr, n, bit});
+    return ret;
+}
+
+void BitView::append(const Piece& p) {
+    if (p.size == 0) {
+        return;
+    }
+    if (!pieces.empty()) {
+        //merge adjacent pieces to keep lookups short
+        auto& last = pieces.back();
+        if (last.bits && p.bits && last.bits + last.size == p.bits) {
+            last.size += p.size;
+            length += p.size;
+            return;
+        }
+        if (!last.bits && !p.bits && last.fill.source() == p.fill.source()) {
+            last.size += p.size;
+            length += p.size;
+            return;
+        }
+    }
+    pieces.push_back(p);
+    length += p.size;
+}
+
+const Circuit::Value& BitView::operator[](unsigned i) const {
+    assert(i < length);
+    for (const auto& p : pieces) {
+        if (i < p.size) {
+            return p.bits ? p.bits[i] : p.fill;
+        }
+        i -= p.size;
+    }
+    //unreachable
+    return pieces.back().fill;
+}
+
+BitView BitView::slice(unsigned lo, unsigned hi) const {
+    assert(lo <= hi && hi <= length);
+    BitView ret;
+    unsigned base = 0;
+    for (const auto& p : pieces) {
+        unsigned a = std::max(lo, base);
+        unsigned b = std::min(hi, base + p.size);
+        if (a < b) {
+            ret.append({p.bits ? p.bits + (a - base) : nullptr, b - a, p.fill});
+        }
+        base += p.size;
+    }
+    return ret;
+}
+
+BitView concat(const BitView& lo, const BitView& hi) {
+    BitView ret{lo};
+    for (const auto& p : hi.pieces) {
+        ret.append(p);
+    }
+    return ret;
+}
+
+void BitView::appendTo(BitVector& v) const {
+    v.reserve(v.size() + length);
+    for (const auto& p : pieces) {
+        if (p.bits) {
+            for (unsigned i = 0; i < p.size; ++i) {
+                v.push_back(p.bits[i]);
+            }
+        }
+        else {
+            for (unsigned i = 0; i < p.size; ++i) {
+                v.push_back(p.fill);
+            }
+        }
+    }
+}
@@ -1,8 +1,12 @@
 #include <CXXSat/Circuit.h>
 #include <CXXSat/Gates.h>
 #include <CXXSat/Variable.h>
+#include <CXXSat/Expr.h>
 #include <CXXSat/Argument.h>
 #include <CXXSat/Sat.h>
+#include <CXXSat/DIMACSWriter.h>
+
+#include <algorithm>
 
 #include "CircuitImpl.h"
 
@@ -23,21 +27,138 @@ Circuit::Circuit() {
     pimpl = std::make_shared<Circuit::impl>();
     pimpl->self = pimpl;
     pimpl->lit0 = Input::create(pimpl);
+    pimpl->lit0->lit = 0;
     pimpl->lit1 = Input::create(pimpl);
+    pimpl->lit1->lit = 1;
 }
 
 const std::weak_ptr<Circuit::impl>& Circuit::pimpl_get_self() const {
     return pimpl->self;
 }
 
+//Asserting that an AND is true asserts each of its inputs (and likewise
+//for an OR being false), so a target such as x == 5 turns into one unit
+//clause per bit of x instead of a single clause on the gate's output.
+static void assertWire(ClauseSink& p, const std::shared_ptr<Circuit::Wire>& w, bool value) {
+    if (auto inv = dynamic_cast<const Circuit::InvertingWire*>(w.get())) {
+        assertWire(p, inv->inverse(), !value);
+        return;
+    }
+    auto node = w->source().get();
+    bool conjunction = value ?
+        (dynamic_cast<AndGate*>(node) || dynamic_cast<MultiAndGate*>(node)) :
+        (dynamic_cast<OrGate*>(node) || dynamic_cast<MultiOrGate*>(node));
+    bool negated = value ?
+        (dynamic_cast<NorGate*>(node) != nullptr) :
+        (dynamic_cast<NandGate*>(node) != nullptr);
+    if (conjunction || negated) {
+        auto gate = node->asGate();
+        for (unsigned i = 0; i < gate->numInputs(); ++i) {
+            assertWire(p, gate->getInput(i), value != negated);
+        }
+    }
+    else {
+        p.addClause({value ? w->ID() : -(w->ID())});
+    }
+}
+
 Problem Circuit::generateCNF(const Variable& b) const {
-    auto cnf = generateCNF();
-    auto bitid = (b.isBit() ? b : b.asBit()).bits[0].getID();
-    cnf.addClause({bitid});
+    auto bit = (b.isBit() ? b : b.asBit()).bits[0];
+    auto cnf = pimpl->generateCNF(bit.source());
+    assertWire(cnf, bit.source(), true);
     return std::move(cnf);
 }
 
+void Circuit::writeDIMACS(const Variable& b, int fd) const {
+    auto bit = (b.isBit() ? b : b.asBit()).bits[0];
+    unsigned vars;
+    auto order = pimpl->number(bit.source(), vars);
+    //the header needs every clause counted, and the target's unit
+    //clauses are few enough to just collect
+    Problem units;
+    assertWire(units, bit.source(), true);
+    DIMACSWriter out(fd, vars, pimpl->countCNF(order) + units.numClauses());
+    pimpl->emitCNF(order, out);
+    for (auto clause : units) {
+        out.addClause(clause.begin(), clause.size());
+    }
+    out.flush();
+}
+
+Problem Circuit::generateCNF(const Expr& e) const {
+    return generateCNF(e.blast());
+}
+
+Problem Circuit::impl::generateCNF(const std::shared_ptr<Wire>& target) {
+    unsigned vars;
+    auto order = number(target, vars);
+    Problem p;
+    //every argument gets a variable, even one the target ignores
+    p.addVariables(vars);
+    //most gates are two-input, three clauses of seven literals
+    p.reserve(3*order.size() + 2, 7*order.size() + 2);
+    emitCNF(order, p);
+    return std::move(p);
+}
+
+std::vector<Circuit::Gate*> Circuit::impl::number(const std::shared_ptr<Wire>& target,
+        unsigned& vars)
+{
+    //walk back from the target to find its cone of influence
+    std::unordered_set<const Node*> cone;
+    std::vector<Gate*> order;
+    std::vector<const Wire*> stack{target.get()};
+    while (!stack.empty()) {
+        auto node = stack.back()->source().get();
+        stack.pop_back();
+        if (!node->isGate() || !cone.insert(node).second) {
+            continue;
+        }
+        auto gate = node->asGate();
+        order.push_back(gate);
+        for (unsigned i = 0; i < gate->numInputs(); ++i) {
+            stack.push_back(gate->getInput(i).get());
+        }
+    }
+    ++numbering;
+    int i = 1;
+    for (auto& wire : wires) {
+        if (wire->source()->isInput() && wire->setID(i)) ++i;
+    }
+    for (auto& wire : wires) {
+        if (!wire->source()->isInput()) {
+            bool used = cone.count(wire->source().get());
+            if (wire->setID(used ? i : 0) && used) ++i;
+        }
+    }
+    vars = i - 1;
+    //inputs come before the gates that use them
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+std::size_t Circuit::impl::countCNF(const std::vector<Gate*>& order) const {
+    std::size_t n = lit0->referenced() + lit1->referenced();
+    for (auto gate : order) {
+        n += gate->numClauses();
+    }
+    return n;
+}
+
+void Circuit::impl::emitCNF(const std::vector<Gate*>& order, ClauseSink& p) const {
+    for (auto gate : order) {
+        gate->emplaceCNF(p);
+    }
+    if (lit0->referenced()) {
+        p.addClause({-(lit0->getID())});
+    }
+    if (lit1->referenced()) {
+        p.addClause({lit1->getID()});
+    }
+}
+
 void Circuit::impl::number() {
+    ++numbering;
     int i = 1;
     for (auto& wire : wires) {
         if (wire->setID(i)) ++i;
@@ -59,6 +180,7 @@ Problem Circuit::generateCNF() const {
 Problem Circuit::impl::generateCNF() {
     number();
     Problem p;
+    p.reserve(3*gates.size() + 2, 7*gates.size() + 2);
     for (auto& gate : gates) {
         gate->emplaceCNF(p);
     }
@@ -71,6 +193,47 @@ Problem Circuit::impl::generateCNF() {
     return std::move(p);
 }
 
+void Circuit::setDivider(Divider d) {
+    pimpl->divider = d;
+}
+
+Circuit::Divider Circuit::getDivider() const {
+    return pimpl->divider;
+}
+
+Circuit::Divider Circuit::getDivider(const std::weak_ptr<Circuit::impl>& c) {
+    auto pimpl = c.lock();
+    assert(pimpl);
+    return pimpl->divider;
+}
+
+void Circuit::setAdder(Adder a) {
+    pimpl->adder = a;
+}
+
+Circuit::Adder Circuit::getAdder() const {
+    return pimpl->adder;
+}
+
+Circuit::Adder Circuit::getAdder(const std::weak_ptr<Circuit::impl>& c) {
+    auto pimpl = c.lock();
+    assert(pimpl);
+    return pimpl->adder;
+}
+
+Circuit::AdderScope::AdderScope(const std::weak_ptr<impl>& c, Adder a) : circuit(c) {
+    auto pimpl = c.lock();
+    assert(pimpl);
+    saved = pimpl->adder;
+    pimpl->adder = a;
+}
+
+Circuit::AdderScope::~AdderScope() {
+    if (auto pimpl = circuit.lock()) {
+        pimpl->adder = saved;
+    }
+}
+
 Circuit::Value Circuit::getLiteralTrue(const std::weak_ptr<Circuit::impl>& c) {
     auto pimpl = c.lock();
     assert(pimpl);
@@ -101,11 +264,6 @@ Circuit::Node::Node(const std::weak_ptr<Circuit::impl>& c, Node::NODE_TYPE t)
                 ptr->reg(asInput());
                 */
                 break;
-            case NODE_TYPE::VALUE:
-                /* don't register
-                ptr->reg(asValue());
-                */
-                break;
             case NODE_TYPE::GATE:
                 ptr->reg(asGate());
                 break;
@@ -124,11 +282,6 @@ Circuit::Node::~Node() {
                 ptr->unreg(asInput());
                 */
                 break;
-            case NODE_TYPE::VALUE:
-                /*
-                ptr->unreg(asValue());
-                */
-                break;
             case NODE_TYPE::GATE:
                 ptr->unreg(asGate());
                 break;
@@ -144,6 +297,10 @@ Circuit::Wire::Wire(const std::shared_ptr<Node>& n)
 {
     if (auto circuit = c.lock()) {
         circuit->reg(this);
+        //sessions number a new input's wire even if the targets ignore it
+        if (n->isInput()) {
+            ++circuit->numbering;
+        }
     }
 }
 
@@ -156,3 +313,7 @@ Circuit::Wire::~Wire() {
 int Circuit::InvertingWire::ID() const {
     return -(((NotGate&)(*from)).source->ID());
 }
+
+std::shared_ptr<Circuit::Wire> Circuit::InvertingWire::inverse() const {
+    return ((NotGate&)(*from)).source;
+}
@@ -1,3 +1,6 @@
+//hash-consed Expr nodes, defined in Expr.cpp
+struct ExprTable;
+
 struct Circuit::impl {
     /*
     void reg(Input* i) {
@@ -34,7 +37,23 @@ struct Circuit::impl {
     std::unordered_set<Gate*> gates;
     std::unordered_set<Wire*> wires;
     std::weak_ptr<Circuit::impl> self;
+    Divider divider = Divider::RESTORING;
+    Adder adder = Adder::RIPPLE;
+    //created by the first Expr built on this circuit
+    std::shared_ptr<ExprTable> exprs;
+    //changes whenever wires are numbered (by generateCNF or a session)
+    //or an input is added, so a SolverSession only restores its numbers
+    //when it has to; never 0
+    std::size_t numbering = 1;
     void number();
     Problem generateCNF();
+    Problem generateCNF(const std::shared_ptr<Wire>& target);
+    //inputs are numbered first, then the wires of the gates feeding
+    //target; other wires get no number.  Returns those gates in the
+    //order their clauses are emitted, and the number of variables.
+    std::vector<Gate*> number(const std::shared_ptr<Wire>& target, unsigned& vars);
+    //the clauses emitCNF adds
+    std::size_t countCNF(const std::vector<Gate*>&) const;
+    void emitCNF(const std::vector<Gate*>&, ClauseSink&) const;
 };
 
@@ -0,0 +1,77 @@
+#include <CXXSat/DIMACSWriter.h>
+
+#include <cstring>
+#include <cerrno>
+#include <cassert>
+#include <system_error>
+#include <unistd.h>
+
+DIMACSWriter::DIMACSWriter(int fd, unsigned vars, std::size_t clauses)
+    : fd{fd}, expected{clauses}, buf{new char[bufsize]}
+{
+    put("p cnf ", 6);
+    putInt(vars);
+    putInt(clauses);
+    buf[len - 1] = '\n';
+}
+
+DIMACSWriter::~DIMACSWriter() {
+    assert(failed || written == expected);
+    //a destructor can't throw, so callers who want to know the output
+    //was all written flush first
+    if (!failed) {
+        try {
+            flush();
+        }
+        catch (const std::system_error&) {
+        }
+    }
+}
+
+void DIMACSWriter::addClause(const int* lits, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        putInt(lits[i]);
+    }
+    put("0\n", 2);
+    ++written;
+}
+
+void DIMACSWriter::flush() {
+    std::size_t done = 0;
+    while (done < len) {
+        auto n = ::write(fd, buf.get() + done, len - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            failed = true;
+            len = 0;
+            throw std::system_error(errno, std::generic_category(), "writing DIMACS");
+        }
+        done += n;
+    }
+    len = 0;
+}
+
+void DIMACSWriter::put(const char* s, std::size_t n) {
+    if (len + n > bufsize) {
+        flush();
+    }
+    std::memcpy(buf.get() + len, s, n);
+    len += n;
+}
+
+//writes i and a space
+void DIMACSWriter::putInt(long long i) {
+    char digits[24];
+    char* end = digits + sizeof(digits);
+    char* p = end;
+    *--p = ' ';
+    unsigned long long u = (i < 0) ? -(unsigned long long)i : i;
+    do {
+        *--p = '0' + u % 10;
+        u /= 10;
+    } while (u);
+    if (i < 0) {
+        *--p = '-';
+    }
+    put(p, end - p);
+}
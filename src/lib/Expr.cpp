@@ -0,0 +1,529 @@
+#include <CXXSat/Expr.h>
+#include <CXXSat/Argument.h>
+
+#include <unordered_map>
+#include <stdint.h>
+
+#include "CircuitImpl.h"
+
+//op, type, then the operands' nodes (or a leaf's wires)
+typedef std::vector<uintptr_t> ExprKey;
+
+struct ExprKeyHash {
+    size_t operator()(const ExprKey& k) const {
+        size_t h = 0;
+        for (auto x : k) {
+            h ^= std::hash<uintptr_t>{}(x) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        }
+        return h;
+    }
+};
+
+struct ExprTable {
+    std::unordered_map<ExprKey, std::weak_ptr<const Expr::Node>, ExprKeyHash> nodes;
+};
+
+struct Expr::Node {
+    Op op;
+    TypeInfo type;
+    std::weak_ptr<Circuit::impl> circuit;
+    std::vector<Expr> args;
+    //only for leaves
+    std::unique_ptr<const Variable> leaf;
+    ExprKey key;
+    //the circuit, once blasted, so later blasts share it
+    mutable std::unique_ptr<const Variable> bits;
+    Node(Op o, TypeInfo t, const std::weak_ptr<Circuit::impl>& c) :
+        op{o}, type{t}, circuit{c} {}
+    ~Node();
+};
+
+Expr::Node::~Node() {
+    auto pimpl = circuit.lock();
+    if (pimpl && pimpl->exprs) {
+        auto& nodes = pimpl->exprs->nodes;
+        auto it = nodes.find(key);
+        if (it != nodes.end() && it->second.expired()) {
+            nodes.erase(it);
+        }
+    }
+}
+
+static uintptr_t encode(Expr::Op op, TypeInfo t) {
+    return ((uintptr_t)t.size() << 8) | ((uintptr_t)t.sign() << 7) | (uintptr_t)op;
+}
+
+static std::shared_ptr<const Expr::Node> intern(const ExprKey& key,
+        std::shared_ptr<Expr::Node> (*create)(const void*), const void* data,
+        const std::weak_ptr<Circuit::impl>& c)
+{
+    auto pimpl = c.lock();
+    assert(pimpl);
+    if (!pimpl->exprs) {
+        pimpl->exprs = std::make_shared<ExprTable>();
+    }
+    auto& entry = pimpl->exprs->nodes[key];
+    if (auto existing = entry.lock()) {
+        return existing;
+    }
+    auto node = create(data);
+    node->key = key;
+    entry = node;
+    return node;
+}
+
+Expr::Expr(const Variable& v) {
+    ExprKey key{encode(Op::LEAF, v.getTypeInfo())};
+    auto bits = v.view();
+    for (unsigned i = 0; i < bits.size(); ++i) {
+        key.push_back((uintptr_t)bits[i].source().get());
+    }
+    node = intern(key, [](const void* data) {
+        auto& var = *static_cast<const Variable*>(data);
+        auto n = std::make_shared<Node>(Op::LEAF, var.getTypeInfo(), var.getCircuit());
+        n->leaf = std::make_unique<const Variable>(var);
+        return n;
+    }, &v, v.getCircuit());
+}
+
+Expr::Expr(const Argument& a) : Expr(a.asValue()) {}
+
+Expr::Op Expr::op() const {
+    return node->op;
+}
+
+TypeInfo Expr::getTypeInfo() const {
+    return node->type;
+}
+
+const std::weak_ptr<Circuit::impl>& Expr::getCircuit() const {
+    return node->circuit;
+}
+
+unsigned Expr::numOperands() const {
+    return node->args.size();
+}
+
+Expr Expr::operand(unsigned i) const {
+    return node->args[i];
+}
+
+bool Expr::isConstant() const {
+    return op() == Op::LEAF && node->leaf->isConstant();
+}
+
+bool Expr::isConstant(bool value) const {
+    if (!isConstant()) {
+        return false;
+    }
+    auto bits = node->leaf->view();
+    for (unsigned i = 0; i < bits.size(); ++i) {
+        if (bits[i].literalValue() != value) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Expr::isAllOnes() const {
+    return isConstant(true);
+}
+
+bool Expr::isOne() const {
+    if (!isConstant()) {
+        return false;
+    }
+    auto bits = node->leaf->view();
+    for (unsigned i = 0; i < bits.size(); ++i) {
+        if (bits[i].literalValue() != (i == 0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//the same operations Variable's operators perform once the operands have
+//been converted, so nothing is converted twice
+static Variable apply(Expr::Op op, TypeInfo type, const std::vector<Variable>& v) {
+    switch (op) {
+    case Expr::Op::NOT:
+        return Variable::Not(v[0]);
+    case Expr::Op::NEG:
+        return Variable::Negative(v[0]);
+    case Expr::Op::ADD:
+        return Variable::Add(v[0], v[1]);
+    case Expr::Op::SUB:
+        return Variable::Sub(v[0], v[1]);
+    case Expr::Op::MUL:
+        return Variable::Mul(v[0], v[1]);
+    case Expr::Op::DIV:
+        return Variable::Div(v[0], v[1]);
+    case Expr::Op::REM:
+        return Variable::Rem(v[0], v[1]);
+    case Expr::Op::SHL:
+        return Variable::Shl(v[0], v[1]);
+    case Expr::Op::SHR:
+        return Variable::Shr(v[0], v[1]);
+    case Expr::Op::AND:
+        return Variable::And(v[0], v[1]);
+    case Expr::Op::OR:
+        return Variable::Or(v[0], v[1]);
+    case Expr::Op::XOR:
+        return Variable::Xor(v[0], v[1]);
+    case Expr::Op::EQ:
+        return Variable::Equal(v[0], v[1]);
+    case Expr::Op::LT:
+        return Variable::Less(v[0], v[1]);
+    case Expr::Op::ITE:
+        //Ternary_ merges the arms with |, which promotes them in C_STYLE
+        //mode; the value is unchanged, so put the type back
+        return Variable::Ternary(v[0], v[1], v[2]).cast(type);
+    case Expr::Op::CAST:
+        return v[0].cast(type);
+    case Expr::Op::LEAF:
+    default:
+        assert(false);
+        return v[0];
+    }
+}
+
+//The nodes whose values n is computed from.  A tree of ADDs of one type
+//is summed all at once with Variable::Sum, so an inner ADD that nothing
+//else refers to (and that has not been blasted) is looked through.
+std::vector<const Expr::Node*> Expr::dependencies(const Node* n) {
+    std::vector<const Node*> deps;
+    std::vector<const Node*> todo{n};
+    while (!todo.empty()) {
+        auto m = todo.back();
+        todo.pop_back();
+        for (const auto& a : m->args) {
+            auto d = a.node.get();
+            if (n->op == Op::ADD && d->op == Op::ADD && d->type == n->type &&
+                    !d->bits && a.node.use_count() == 1) {
+                todo.push_back(d);
+            }
+            else {
+                deps.push_back(d);
+            }
+        }
+    }
+    return deps;
+}
+
+Variable Expr::blast() const {
+    //post-order over the DAG without recursion, as chains get long
+    std::vector<const Node*> stack{node.get()};
+    while (!stack.empty()) {
+        auto n = stack.back();
+        if (n->bits) {
+            stack.pop_back();
+            continue;
+        }
+        if (n->op == Op::LEAF) {
+            n->bits = std::make_unique<const Variable>(*n->leaf);
+            stack.pop_back();
+            continue;
+        }
+        auto deps = dependencies(n);
+        bool ready = true;
+        for (auto d : deps) {
+            if (!d->bits) {
+                stack.push_back(d);
+                ready = false;
+            }
+        }
+        if (!ready) {
+            continue;
+        }
+        std::vector<Variable> operands;
+        for (auto d : deps) {
+            operands.push_back(*d->bits);
+        }
+        if (n->op == Op::ADD) {
+            n->bits = std::make_unique<const Variable>(Variable::Sum(operands));
+        }
+        else {
+            n->bits = std::make_unique<const Variable>(apply(n->op, n->type, operands));
+        }
+        stack.pop_back();
+    }
+    return *node->bits;
+}
+
+Expr Expr::make(Op op, TypeInfo type, std::vector<Expr> args) {
+    auto s = simplify(op, type, args);
+    if (s.node) {
+        return s;
+    }
+    switch (op) {
+    case Op::ADD:
+    case Op::MUL:
+    case Op::AND:
+    case Op::OR:
+    case Op::XOR:
+    case Op::EQ:
+        //commutative: one order, so both share a node
+        if (args[0].node > args[1].node) {
+            std::swap(args[0], args[1]);
+        }
+        break;
+    default:
+        break;
+    }
+    bool constant = std::all_of(args.begin(), args.end(), [](const Expr& e) {
+        return e.isConstant();
+    });
+    if (constant) {
+        //anything the circuit folds down to literals is just a constant
+        std::vector<Variable> operands;
+        for (const auto& a : args) {
+            operands.push_back(*a.node->leaf);
+        }
+        auto v = apply(op, type, operands);
+        if (v.isConstant()) {
+            return Expr(v);
+        }
+    }
+    ExprKey key{encode(op, type)};
+    for (const auto& a : args) {
+        key.push_back((uintptr_t)a.node.get());
+    }
+    struct Data {
+        Op op;
+        TypeInfo type;
+        std::vector<Expr>& args;
+    } data{op, type, args};
+    return Expr(intern(key, [](const void* p) {
+        auto& d = *static_cast<const Data*>(p);
+        auto n = std::make_shared<Node>(d.op, d.type, d.args[0].getCircuit());
+        n->args = std::move(d.args);
+        return n;
+    }, &data, args[0].getCircuit()));
+}
+
+Expr Expr::simplify(Op op, TypeInfo type, const std::vector<Expr>& args) {
+    const auto& c = args[0].getCircuit();
+    auto zero = [&c, type]() {
+        return Expr(Variable(0, c, type));
+    };
+    auto bit = [&c](bool b) {
+        return Expr(Circuit::getLiteralBit(c, b));
+    };
+    const auto& a = args[0];
+    switch (op) {
+    case Op::NOT:
+    case Op::NEG:
+        if (a.op() == op) {
+            return a.operand(0);
+        }
+        if (op == Op::NEG && a.isZero()) {
+            return a;
+        }
+        break;
+    case Op::CAST:
+        if (a.getTypeInfo() == type) {
+            return a;
+        }
+        break;
+    case Op::ITE:
+        if (a.isConstant()) {
+            return a.isZero() ? args[2] : args[1];
+        }
+        if (args[1].same(args[2])) {
+            return args[1];
+        }
+        break;
+    default:
+        break;
+    }
+    if (args.size() != 2) {
+        return Expr(nullptr);
+    }
+    const auto& b = args[1];
+    switch (op) {
+    case Op::ADD:
+        if (b.isZero()) return a;
+        if (a.isZero()) return b;
+        break;
+    case Op::SUB:
+        if (b.isZero()) return a;
+        if (a.same(b)) return zero();
+        break;
+    case Op::MUL:
+        if (a.isZero()) return a;
+        if (b.isZero()) return b;
+        if (b.isOne()) return a;
+        if (a.isOne()) return b;
+        break;
+    case Op::DIV:
+        if (b.isOne()) return a;
+        break;
+    case Op::REM:
+        if (b.isOne()) return zero();
+        break;
+    case Op::SHL:
+    case Op::SHR:
+        if (a.isZero() || b.isZero()) return a;
+        break;
+    case Op::AND:
+        if (a.same(b)) return a;
+        if (a.isZero() || b.isAllOnes()) return a;
+        if (b.isZero() || a.isAllOnes()) return b;
+        break;
+    case Op::OR:
+        if (a.same(b)) return a;
+        if (a.isZero() || b.isAllOnes()) return b;
+        if (b.isZero() || a.isAllOnes()) return a;
+        break;
+    case Op::XOR:
+        if (a.same(b)) return zero();
+        if (b.isZero()) return a;
+        if (a.isZero()) return b;
+        break;
+    case Op::EQ:
+        if (a.same(b)) return bit(true);
+        break;
+    case Op::LT:
+        if (a.same(b)) return bit(false);
+        break;
+    default:
+        break;
+    }
+    return Expr(nullptr);
+}
+
+//the usual arithmetic conversions, as Variable's operators apply them
+static TypeInfo converted(TypeInfo a, TypeInfo b) {
+    auto t = Variable::converted(a, b);
+    //a Variable one bit wide is always a bit
+    if (t.size() == 1) {
+        return TypeInfo::createBit();
+    }
+    return t;
+}
+
+Expr Expr::binary(Op op, const Expr& a, const Expr& b) {
+    auto t = converted(a.getTypeInfo(), b.getTypeInfo());
+    return make(op, t, {a.cast(t), b.cast(t)});
+}
+
+Expr Expr::compare(Op op, const Expr& a, const Expr& b) {
+    auto t = converted(a.getTypeInfo(), b.getTypeInfo());
+    return make(op, TypeInfo::createBit(), {a.cast(t), b.cast(t)});
+}
+
+Expr Expr::logic(Op op, const Expr& a, const Expr& b) {
+    if (a.getTypeInfo().isBit() && b.getTypeInfo().isBit()) {
+        return make(op, TypeInfo::createBit(), {a, b});
+    }
+    return binary(op, a, b);
+}
+
+Expr Expr::cast(TypeInfo t) const {
+    if (t == getTypeInfo()) {
+        return *this;
+    }
+    return make(Op::CAST, t, {*this});
+}
+
+Expr Expr::asBit() const {
+    return cast(TypeInfo::createBit());
+}
+
+Expr Expr::Ternary(const Expr& cond, const Expr& a, const Expr& b) {
+    auto t = a.getTypeInfo() == b.getTypeInfo() ? a.getTypeInfo() :
+        converted(a.getTypeInfo(), b.getTypeInfo());
+    return make(Op::ITE, t, {cond.asBit(), a.cast(t), b.cast(t)});
+}
+
+Expr Expr::operator~() const {
+    return make(Op::NOT, getTypeInfo(), {*this});
+}
+
+Expr Expr::operator-() const {
+    //negated at its own width first, like Variable::Minus
+    return +make(Op::NEG, getTypeInfo(), {*this});
+}
+
+Expr Expr::operator+() const {
+    if (getTypeInfo().size() < int_size) {
+        return cast(TypeInfo(true, int_size));
+    }
+    return *this;
+}
+
+Expr Expr::operator!() const {
+    return make(Op::NOT, TypeInfo::createBit(), {asBit()});
+}
+
+Expr operator+(const Expr& a, const Expr& b) {
+    return Expr::binary(Expr::Op::ADD, a, b);
+}
+
+Expr operator-(const Expr& a, const Expr& b) {
+    return Expr::binary(Expr::Op::SUB, a, b);
+}
+
+Expr operator*(const Expr& a, const Expr& b) {
+    return Expr::binary(Expr::Op::MUL, a, b);
+}
+
+Expr operator/(const Expr& a, const Expr& b) {
+    return Expr::binary(Expr::Op::DIV, a, b);
+}
+
+Expr operator%(const Expr& a, const Expr& b) {
+    return Expr::binary(Expr::Op::REM, a, b);
+}
+
+Expr operator<<(const Expr& a, const Expr& b) {
+    return Expr::binary(Expr::Op::SHL, a, b);
+}
+
+Expr operator>>(const Expr& a, const Expr& b) {
+    return Expr::binary(Expr::Op::SHR, a, b);
+}
+
+Expr operator&(const Expr& a, const Expr& b) {
+    return Expr::logic(Expr::Op::AND, a, b);
+}
+
+Expr operator|(const Expr& a, const Expr& b) {
+    return Expr::logic(Expr::Op::OR, a, b);
+}
+
+Expr operator^(const Expr& a, const Expr& b) {
+    return Expr::logic(Expr::Op::XOR, a, b);
+}
+
+Expr operator&&(const Expr& a, const Expr& b) {
+    return a.asBit() & b.asBit();
+}
+
+Expr operator||(const Expr& a, const Expr& b) {
+    return a.asBit() | b.asBit();
+}
+
+Expr operator==(const Expr& a, const Expr& b) {
+    return Expr::compare(Expr::Op::EQ, a, b);
+}
+
+Expr operator!=(const Expr& a, const Expr& b) {
+    return !(a == b);
+}
+
+Expr operator<(const Expr& a, const Expr& b) {
+    return Expr::compare(Expr::Op::LT, a, b);
+}
+
+Expr operator>(const Expr& a, const Expr& b) {
+    return b < a;
+}
+
+Expr operator<=(const Expr& a, const Expr& b) {
+    return !(b < a);
+}
+
+Expr operator>=(const Expr& a, const Expr& b) {
+    return !(a < b);
+}
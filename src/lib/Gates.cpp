@@ -1,9 +1,11 @@
 #include <CXXSat/Gates.h>
 #include <CXXSat/Sat.h>
 
+#include <array>
+
 // From http://en.wikipedia.org/wiki/Tseitin_transformation
 
-void NotGate::emplaceCNF(Problem&) {
+void NotGate::emplaceCNF(ClauseSink&) {
     //using special wire - no cnf needed
     /*
     auto A = source->ID();
@@ -20,7 +22,7 @@ std::shared_ptr<Circuit::Wire> NotGate::create(const Circuit::Value& val) {
     return std::move(wire);
 }
 
-void AndGate::emplaceCNF(Problem& p) {
+void AndGate::emplaceCNF(ClauseSink& p) {
     auto A = a->ID();
     auto B = b->ID();
     auto C = getWire()->ID();
@@ -29,7 +31,7 @@ void AndGate::emplaceCNF(Problem& p) {
     p.addClause({B, -C});
 }
 
-void NandGate::emplaceCNF(Problem& p) {
+void NandGate::emplaceCNF(ClauseSink& p) {
     auto A = a->ID();
     auto B = b->ID();
     auto C = getWire()->ID();
@@ -38,7 +40,7 @@ void NandGate::emplaceCNF(Problem& p) {
     p.addClause({B, C});
 }
 
-void OrGate::emplaceCNF(Problem& p) {
+void OrGate::emplaceCNF(ClauseSink& p) {
     auto A = a->ID();
     auto B = b->ID();
     auto C = getWire()->ID();
@@ -47,7 +49,7 @@ void OrGate::emplaceCNF(Problem& p) {
     p.addClause({-B, C});
 }
 
-void NorGate::emplaceCNF(Problem& p) {
+void NorGate::emplaceCNF(ClauseSink& p) {
     auto A = a->ID();
     auto B = b->ID();
     auto C = getWire()->ID();
@@ -56,7 +58,7 @@ void NorGate::emplaceCNF(Problem& p) {
     p.addClause({-B, -C});
 }
 
-void XorGate::emplaceCNF(Problem& p) {
+void XorGate::emplaceCNF(ClauseSink& p) {
     auto A = a->ID();
     auto B = b->ID();
     auto C = getWire()->ID();
@@ -66,7 +68,7 @@ void XorGate::emplaceCNF(Problem& p) {
     p.addClause({-A, B, C});
 }
 
-void XnorGate::emplaceCNF(Problem& p) {
+void XnorGate::emplaceCNF(ClauseSink& p) {
     auto A = a->ID();
     auto B = b->ID();
     auto C = getWire()->ID();
@@ -76,7 +78,11 @@ void XnorGate::emplaceCNF(Problem& p) {
     p.addClause({-A, B, -C});
 }
 
-void MultiAndGate::emplaceCNF(Problem& p) {
+unsigned MultiAndGate::numClauses() const {
+    return inputs.size() + 1;
+}
+
+void MultiAndGate::emplaceCNF(ClauseSink& p) {
     auto out = getWire()->ID();
     Clause c;
     for (auto& i : inputs) {
@@ -88,7 +94,11 @@ void MultiAndGate::emplaceCNF(Problem& p) {
     p.addClause(c);
 }
 
-void MultiOrGate::emplaceCNF(Problem& p) {
+unsigned MultiOrGate::numClauses() const {
+    return inputs.size() + 1;
+}
+
+void MultiOrGate::emplaceCNF(ClauseSink& p) {
     auto out = getWire()->ID();
     Clause c;
     for (auto& i : inputs) {
@@ -100,43 +110,128 @@ void MultiOrGate::emplaceCNF(Problem& p) {
     p.addClause(c);
 }
 
+//The gate constructors below fold away literal inputs, repeated inputs and
+//complementary inputs, so constant bits never make it into the CNF.
+
+static bool sameValue(const Circuit::Value& a, const Circuit::Value& b) {
+    return a.source() == b.source();
+}
+
+static bool complementary(const Circuit::Value& a, const Circuit::Value& b) {
+    auto x = a.source();
+    auto y = b.source();
+    if (auto inv = dynamic_cast<const Circuit::InvertingWire*>(x.get())) {
+        if (inv->inverse() == y) return true;
+    }
+    if (auto inv = dynamic_cast<const Circuit::InvertingWire*>(y.get())) {
+        if (inv->inverse() == x) return true;
+    }
+    return false;
+}
+
+static Circuit::Value literal(const Circuit::Value& v, bool b) {
+    return b ? Circuit::getLiteralTrue(v.getCircuit())
+        : Circuit::getLiteralFalse(v.getCircuit());
+}
+
+unsigned MajorityGate::numClauses() const {
+    return 6;
+}
+
+void MajorityGate::emplaceCNF(ClauseSink& p) {
+    assert(inputs.size() == 3);
+    auto A = inputs[0]->ID();
+    auto B = inputs[1]->ID();
+    auto C = inputs[2]->ID();
+    auto O = getWire()->ID();
+    p.addClause({-A, -B, O});
+    p.addClause({-A, -C, O});
+    p.addClause({-B, -C, O});
+    p.addClause({A, B, -O});
+    p.addClause({A, C, -O});
+    p.addClause({B, C, -O});
+}
+
 Circuit::Value And(const Circuit::Value& a, const Circuit::Value& b) {
+    if (a.isLiteral()) return a.literalValue() ? b : a;
+    if (b.isLiteral()) return b.literalValue() ? a : b;
+    if (sameValue(a, b)) return a;
+    if (complementary(a, b)) return literal(a, false);
     return Circuit::Value{AndGate::create(a, b)};
 }
 
 Circuit::Value Nand(const Circuit::Value& a, const Circuit::Value& b) {
+    if (a.isLiteral() || b.isLiteral() || sameValue(a, b) || complementary(a, b)) {
+        return Not(And(a, b));
+    }
     return Circuit::Value{NandGate::create(a, b)};
 }
 
 Circuit::Value Or(const Circuit::Value& a, const Circuit::Value& b) {
+    if (a.isLiteral()) return a.literalValue() ? a : b;
+    if (b.isLiteral()) return b.literalValue() ? b : a;
+    if (sameValue(a, b)) return a;
+    if (complementary(a, b)) return literal(a, true);
     return Circuit::Value{OrGate::create(a, b)};
 }
 
 Circuit::Value Nor(const Circuit::Value& a, const Circuit::Value& b) {
+    if (a.isLiteral() || b.isLiteral() || sameValue(a, b) || complementary(a, b)) {
+        return Not(Or(a, b));
+    }
     return Circuit::Value{NorGate::create(a, b)};
 }
 
 Circuit::Value Xor(const Circuit::Value& a, const Circuit::Value& b) {
+    if (a.isLiteral()) return a.literalValue() ? Not(b) : b;
+    if (b.isLiteral()) return b.literalValue() ? Not(a) : a;
+    if (sameValue(a, b)) return literal(a, false);
+    if (complementary(a, b)) return literal(a, true);
     return Circuit::Value{XorGate::create(a, b)};
 }
 
 Circuit::Value Xnor(const Circuit::Value& a, const Circuit::Value& b) {
+    if (a.isLiteral() || b.isLiteral() || sameValue(a, b) || complementary(a, b)) {
+        return Not(Xor(a, b));
+    }
     return Circuit::Value{XnorGate::create(a, b)};
 }
 
 Circuit::Value Not(const Circuit::Value& a) {
+    if (a.isLiteral()) {
+        return literal(a, !a.literalValue());
+    }
+    if (auto inv = dynamic_cast<const Circuit::InvertingWire*>(a.source().get())) {
+        return Circuit::Value{inv->inverse()};
+    }
     return Circuit::Value{NotGate::create(a)};
 }
 
+Circuit::Value Majority(const Circuit::Value& a, const Circuit::Value& b,
+        const Circuit::Value& c)
+{
+    //a literal input decides between the other two
+    if (a.isLiteral()) return a.literalValue() ? Or(b, c) : And(b, c);
+    if (b.isLiteral()) return b.literalValue() ? Or(a, c) : And(a, c);
+    if (c.isLiteral()) return c.literalValue() ? Or(a, b) : And(a, b);
+    //as does a pair of equal or complementary inputs
+    if (sameValue(a, b)) return a;
+    if (sameValue(a, c)) return a;
+    if (sameValue(b, c)) return b;
+    if (complementary(a, b)) return c;
+    if (complementary(a, c)) return b;
+    if (complementary(b, c)) return a;
+    return Circuit::Value{MajorityGate::create(std::array<Circuit::Value, 3>{{a, b, c}})};
+}
+
 AdderResT FullAdder(
         const Circuit::Value& a,
         const Circuit::Value& b,
         const Circuit::Value& carry)
 {
-    auto half_sum = Xor(a, b);
     return {
-        {Xor(half_sum, carry)},
-        {Or(And(a, b), And(half_sum, carry))}
+        {Xor(Xor(a, b), carry)},
+        {Majority(a, b, carry)}
     };
 }
 
@@ -0,0 +1,682 @@
+#include <CXXSat/Preprocessor.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include <cassert>
+#include <utility>
+#include <initializer_list>
+
+//how many rounds of all the techniques, at most
+static const unsigned maxRounds = 8;
+//literals visited by subsumption and by probing in one round, so a huge
+//problem still gets through quickly
+static const std::size_t maxEffort = 20000000;
+//a variable occurring in more clauses than this (of both signs) is not
+//eliminated, nor is one with a resolvent longer than maxResolvent
+static const std::size_t maxOccurrences = 24;
+static const std::size_t maxResolvent = 24;
+
+//a bit for each variable (mod 64), so most clauses that cannot contain
+//another are rejected without looking at their literals
+static std::uint64_t signature(const std::vector<int>& c) {
+    std::uint64_t s = 0;
+    for (int lit : c) {
+        s |= std::uint64_t(1) << (std::abs(lit) % 64);
+    }
+    return s;
+}
+
+//the resolvent of c and d on var, or false if it is a tautology
+static bool resolve(const std::vector<int>& c, const std::vector<int>& d, int var,
+        std::vector<int>& out)
+{
+    out.clear();
+    for (int lit : c) {
+        if (lit != var) {
+            out.push_back(lit);
+        }
+    }
+    std::size_t n = out.size();
+    for (int lit : d) {
+        if (lit == -var) {
+            continue;
+        }
+        if (std::find(out.begin(), out.begin() + n, -lit) != out.begin() + n) {
+            return false;
+        }
+        if (std::find(out.begin(), out.begin() + n, lit) == out.begin() + n) {
+            out.push_back(lit);
+        }
+    }
+    return true;
+}
+
+//true if one of the clauses in list has exactly the literals lits
+static bool has(const std::vector<std::vector<int>>& clauses, const std::vector<unsigned>& list,
+        std::initializer_list<int> lits, std::vector<bool>& mark)
+{
+    for (std::size_t i = 0; i < list.size(); ++i) {
+        const auto& c = clauses[list[i]];
+        if (c.size() == lits.size() && std::all_of(lits.begin(), lits.end(), [&](int lit) {
+                    return std::find(c.begin(), c.end(), lit) != c.end(); })) {
+            mark[i] = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+//Looks among pos (the clauses with var) and neg (those with -var) for
+//ones defining var as an and, or or xor of other literals, the way the
+//gates are encoded, and marks them in gp and gn.  Two defining clauses
+//only resolve to tautologies, and two others to what the remaining
+//resolvents imply, so var can be eliminated with just the resolvents of
+//a defining clause and another.
+static bool definition(const std::vector<std::vector<int>>& clauses, int var,
+        const std::vector<unsigned>& pos, const std::vector<unsigned>& neg,
+        std::vector<bool>& gp, std::vector<bool>& gn)
+{
+    gp.assign(pos.size(), false);
+    gn.assign(neg.size(), false);
+    //(s -a -b ...) and (-s a), (-s b)...: s is an and (or, for -var)
+    for (int s : {var, -var}) {
+        const auto& big = (s == var) ? pos : neg;
+        const auto& bin = (s == var) ? neg : pos;
+        auto& big_mark = (s == var) ? gp : gn;
+        auto& bin_mark = (s == var) ? gn : gp;
+        for (std::size_t i = 0; i < big.size(); ++i) {
+            const auto& c = clauses[big[i]];
+            bool defines = c.size() > 1;
+            for (int lit : c) {
+                if (lit != s && defines) {
+                    defines = has(clauses, bin, {-s, -lit}, bin_mark);
+                }
+            }
+            if (defines) {
+                big_mark[i] = true;
+                return true;
+            }
+            std::fill(bin_mark.begin(), bin_mark.end(), false);
+        }
+    }
+    //the four clauses of var = a xor b (or xnor)
+    for (std::size_t i = 0; i < pos.size(); ++i) {
+        const auto& c = clauses[pos[i]];
+        if (c.size() != 3) {
+            continue;
+        }
+        int a = (c[0] == var) ? c[1] : c[0];
+        int b = (c[2] == var) ? c[1] : c[2];
+        if (has(clauses, pos, {var, -a, -b}, gp) && has(clauses, neg, {-var, -a, b}, gn) &&
+                has(clauses, neg, {-var, a, -b}, gn)) {
+            gp[i] = true;
+            return true;
+        }
+        std::fill(gp.begin(), gp.end(), false);
+        std::fill(gn.begin(), gn.end(), false);
+    }
+    return false;
+}
+
+Preprocessor::Preprocessor(const Problem& p)
+    : n{p.numVars()}, occ(2*(n+1)), vals(n+1), frozen(n+1), gone(n+1)
+{
+    clauses.reserve(p.numClauses());
+    dead.reserve(p.numClauses());
+    for (auto c : p) {
+        add(std::vector<int>(c.begin(), c.end()));
+    }
+}
+
+void Preprocessor::freeze(int var) {
+    assert(var > 0 && (unsigned)var <= n && !simplified);
+    frozen[var] = true;
+}
+
+void Preprocessor::freeze(const std::vector<int>& vars) {
+    for (int var : vars) {
+        freeze(var);
+    }
+}
+
+bool Preprocessor::contains(unsigned c, int lit) const {
+    return !dead[c] && std::find(clauses[c].begin(), clauses[c].end(), lit) != clauses[c].end();
+}
+
+const std::vector<unsigned>& Preprocessor::occurrences(int lit) {
+    auto& list = occ[index(lit)];
+    list.erase(std::remove_if(list.begin(), list.end(),
+                [&](unsigned c) { return !contains(c, lit); }), list.end());
+    return list;
+}
+
+void Preprocessor::add(std::vector<int> c) {
+    //by variable, so a literal and its negation end up side by side
+    std::sort(c.begin(), c.end(), [](int a, int b) {
+            return std::abs(a) < std::abs(b) || (std::abs(a) == std::abs(b) && a < b); });
+    c.erase(std::unique(c.begin(), c.end()), c.end());
+    for (std::size_t i = 0; i + 1 < c.size(); ++i) {
+        if (c[i] == -c[i+1]) {
+            return;
+        }
+    }
+    for (int lit : c) {
+        if (value(lit) > 0) {
+            return;
+        }
+    }
+    c.erase(std::remove_if(c.begin(), c.end(), [&](int lit) { return value(lit) < 0; }), c.end());
+    if (c.empty()) {
+        unsat = true;
+        return;
+    }
+    if (c.size() == 1) {
+        assign(c[0]);
+        return;
+    }
+    unsigned i = clauses.size();
+    for (int lit : c) {
+        occ[index(lit)].push_back(i);
+    }
+    clauses.push_back(std::move(c));
+    dead.push_back(false);
+}
+
+void Preprocessor::remove(unsigned c) {
+    dead[c] = true;
+    std::vector<int>().swap(clauses[c]);
+}
+
+void Preprocessor::assign(int lit) {
+    vals[std::abs(lit)] = (lit > 0) ? 1 : -1;
+    trail.push_back(lit);
+}
+
+bool Preprocessor::propagate() {
+    bool changed = head < trail.size();
+    while (!unsat && head < trail.size()) {
+        int lit = trail[head++];
+        for (unsigned c : occurrences(lit)) {
+            remove(c);
+        }
+        for (unsigned c : occurrences(-lit)) {
+            auto& cl = clauses[c];
+            cl.erase(std::find(cl.begin(), cl.end(), -lit));
+            if (cl.size() == 1) {
+                int unit = cl[0];
+                remove(c);
+                if (value(unit) < 0) {
+                    unsat = true;
+                }
+                else if (value(unit) == 0) {
+                    assign(unit);
+                }
+            }
+        }
+    }
+    return changed;
+}
+
+void Preprocessor::rebuild() {
+    auto old = std::move(clauses);
+    auto was_dead = std::move(dead);
+    clauses.clear();
+    dead.clear();
+    for (auto& list : occ) {
+        list.clear();
+    }
+    for (std::size_t i = 0; i < old.size(); ++i) {
+        if (!was_dead[i]) {
+            add(std::move(old[i]));
+        }
+    }
+}
+
+bool Preprocessor::substitute() {
+    //literal l is node index(l); a binary clause (a b) gives the edges
+    //-a -> b and -b -> a, and a cycle of implications makes its literals
+    //equivalent
+    std::size_t nodes = 2*(n+1);
+    std::vector<std::vector<unsigned>> succ(nodes);
+    for (std::size_t c = 0; c < clauses.size(); ++c) {
+        if (!dead[c] && clauses[c].size() == 2) {
+            int a = clauses[c][0], b = clauses[c][1];
+            succ[index(-a)].push_back(index(b));
+            succ[index(-b)].push_back(index(a));
+        }
+    }
+    auto literal = [](unsigned node) {
+        return (node & 1) ? -(int)(node >> 1) : (int)(node >> 1);
+    };
+    //the literal each substituted variable is equivalent to
+    std::vector<int> repl(n+1);
+    bool found = false;
+
+    //Tarjan's algorithm, with explicit stacks
+    std::vector<int> order(nodes, -1), low(nodes);
+    std::vector<bool> on_stack(nodes);
+    std::vector<unsigned> visiting;
+    std::vector<std::pair<unsigned, std::size_t>> calls;
+    int counter = 0;
+    for (unsigned root = 2; root < nodes && !unsat; ++root) {
+        if (order[root] != -1 || succ[root].empty()) {
+            continue;
+        }
+        order[root] = low[root] = counter++;
+        visiting.push_back(root);
+        on_stack[root] = true;
+        calls.emplace_back(root, 0);
+        while (!calls.empty() && !unsat) {
+            unsigned v = calls.back().first;
+            if (calls.back().second < succ[v].size()) {
+                unsigned w = succ[v][calls.back().second++];
+                if (order[w] == -1) {
+                    order[w] = low[w] = counter++;
+                    visiting.push_back(w);
+                    on_stack[w] = true;
+                    calls.emplace_back(w, 0);
+                }
+                else if (on_stack[w]) {
+                    low[v] = std::min(low[v], order[w]);
+                }
+                continue;
+            }
+            calls.pop_back();
+            if (!calls.empty()) {
+                unsigned u = calls.back().first;
+                low[u] = std::min(low[u], low[v]);
+            }
+            if (low[v] != order[v]) {
+                continue;
+            }
+            std::vector<int> comp;
+            unsigned w;
+            do {
+                w = visiting.back();
+                visiting.pop_back();
+                on_stack[w] = false;
+                comp.push_back(literal(w));
+            } while (w != v);
+            if (comp.size() < 2) {
+                continue;
+            }
+            //the representative is the lowest frozen variable, or else the
+            //lowest variable, so the mirror image of this component (the
+            //negations) picks the same one
+            std::sort(comp.begin(), comp.end(), [](int a, int b) {
+                    return std::abs(a) < std::abs(b); });
+            int rep = comp[0];
+            for (int lit : comp) {
+                if (frozen[std::abs(lit)]) {
+                    rep = lit;
+                    break;
+                }
+            }
+            for (std::size_t i = 0; i + 1 < comp.size(); ++i) {
+                if (comp[i] == -comp[i+1]) {
+                    //a literal equivalent to its own negation
+                    unsat = true;
+                }
+            }
+            for (int lit : comp) {
+                int var = std::abs(lit);
+                if (var == std::abs(rep) || frozen[var] || repl[var]) {
+                    continue;
+                }
+                repl[var] = (lit > 0) ? rep : -rep;
+                found = true;
+            }
+        }
+        calls.clear();
+    }
+    if (unsat || !found) {
+        return false;
+    }
+    for (unsigned var = 1; var <= n; ++var) {
+        int r = repl[var];
+        if (!r) {
+            continue;
+        }
+        int v = var;
+        stack.push_back({v, {v, -r}});
+        stack.push_back({-v, {-v, r}});
+        gone[var] = true;
+        ++counts.substituted;
+    }
+    for (std::size_t c = 0; c < clauses.size(); ++c) {
+        if (dead[c]) {
+            continue;
+        }
+        for (int& lit : clauses[c]) {
+            int r = repl[std::abs(lit)];
+            if (r) {
+                lit = (lit > 0) ? r : -r;
+            }
+        }
+    }
+    rebuild();
+    return true;
+}
+
+bool Preprocessor::subsume() {
+    std::vector<unsigned> by_size;
+    std::vector<std::uint64_t> sigs(clauses.size());
+    for (unsigned c = 0; c < clauses.size(); ++c) {
+        if (!dead[c]) {
+            by_size.push_back(c);
+            sigs[c] = signature(clauses[c]);
+        }
+    }
+    std::stable_sort(by_size.begin(), by_size.end(), [&](unsigned a, unsigned b) {
+            return clauses[a].size() < clauses[b].size(); });
+    std::vector<char> mark(2*(n+1));
+    std::size_t effort = 0;
+    bool changed = false;
+    for (unsigned c : by_size) {
+        if (unsat || effort > maxEffort) {
+            break;
+        }
+        if (dead[c]) {
+            continue;
+        }
+        const auto& cl = clauses[c];
+        //every clause c subsumes or strengthens has the variable of each
+        //of its literals, so look at the one occurring least
+        int m = cl[0];
+        for (int lit : cl) {
+            if (occ[index(lit)].size() + occ[index(-lit)].size() <
+                    occ[index(m)].size() + occ[index(-m)].size()) {
+                m = lit;
+            }
+        }
+        for (int sign : {m, -m}) {
+            for (unsigned d : occurrences(sign)) {
+                if (d == c || dead[d] || clauses[d].size() < cl.size() ||
+                        (sigs[c] & ~sigs[d])) {
+                    continue;
+                }
+                auto& dl = clauses[d];
+                effort += cl.size() + dl.size();
+                for (int lit : dl) {
+                    mark[index(lit)] = 1;
+                }
+                //the literal of c negated in d, if there is one
+                int flipped = 0;
+                bool within = true;
+                for (int lit : cl) {
+                    if (mark[index(lit)]) {
+                        continue;
+                    }
+                    if (mark[index(-lit)] && !flipped) {
+                        flipped = lit;
+                        continue;
+                    }
+                    within = false;
+                    break;
+                }
+                for (int lit : dl) {
+                    mark[index(lit)] = 0;
+                }
+                if (!within) {
+                    continue;
+                }
+                changed = true;
+                if (!flipped) {
+                    remove(d);
+                    ++counts.subsumed;
+                    continue;
+                }
+                //resolving c and d on flipped gives d without -flipped
+                dl.erase(std::find(dl.begin(), dl.end(), -flipped));
+                ++counts.strengthened;
+                sigs[d] = signature(dl);
+                if (dl.size() == 1) {
+                    int unit = dl[0];
+                    remove(d);
+                    if (value(unit) < 0) {
+                        unsat = true;
+                    }
+                    else if (value(unit) == 0) {
+                        assign(unit);
+                    }
+                }
+            }
+        }
+    }
+    return changed;
+}
+
+bool Preprocessor::failed(int lit, std::size_t& effort) {
+    std::size_t start = trail.size();
+    assign(lit);
+    bool conflict = false;
+    for (std::size_t i = start; i < trail.size() && !conflict; ++i) {
+        for (unsigned c : occ[index(-trail[i])]) {
+            if (dead[c]) {
+                continue;
+            }
+            effort += clauses[c].size();
+            int unit = 0;
+            unsigned open = 0;
+            bool satisfied = false;
+            for (int l : clauses[c]) {
+                int v = value(l);
+                if (v > 0) {
+                    satisfied = true;
+                    break;
+                }
+                if (v == 0) {
+                    unit = l;
+                    if (++open > 1) {
+                        break;
+                    }
+                }
+            }
+            if (satisfied || open > 1) {
+                continue;
+            }
+            if (open == 0) {
+                conflict = true;
+                break;
+            }
+            assign(unit);
+        }
+    }
+    for (std::size_t i = start; i < trail.size(); ++i) {
+        vals[std::abs(trail[i])] = 0;
+    }
+    trail.resize(start);
+    return conflict;
+}
+
+bool Preprocessor::probe() {
+    //probing a variable with no binary clauses seldom propagates far
+    std::vector<bool> binary(n+1);
+    for (std::size_t c = 0; c < clauses.size(); ++c) {
+        if (!dead[c] && clauses[c].size() == 2) {
+            binary[std::abs(clauses[c][0])] = true;
+            binary[std::abs(clauses[c][1])] = true;
+        }
+    }
+    std::size_t effort = 0;
+    bool changed = false;
+    for (unsigned var = 1; var <= n && !unsat && effort <= maxEffort; ++var) {
+        if (!binary[var] || gone[var]) {
+            continue;
+        }
+        int v = var;
+        for (int lit : {v, -v}) {
+            if (value(lit) != 0) {
+                break;
+            }
+            if (failed(lit, effort)) {
+                assign(-lit);
+                ++counts.failed;
+                changed = true;
+                propagate();
+            }
+        }
+    }
+    return changed;
+}
+
+bool Preprocessor::eliminate() {
+    std::vector<unsigned> candidates;
+    std::vector<std::size_t> cost(n+1);
+    for (unsigned var = 1; var <= n; ++var) {
+        if (frozen[var] || gone[var] || vals[var]) {
+            continue;
+        }
+        int v = var;
+        cost[var] = occurrences(v).size() + occurrences(-v).size();
+        if (cost[var]) {
+            candidates.push_back(var);
+        }
+    }
+    //the cheapest first, as eliminating them seldom adds anything
+    std::stable_sort(candidates.begin(), candidates.end(), [&](unsigned a, unsigned b) {
+            return cost[a] < cost[b]; });
+    bool changed = false;
+    std::vector<std::vector<int>> resolvents;
+    std::vector<int> r;
+    std::vector<bool> gp, gn;
+    for (unsigned var : candidates) {
+        if (unsat) {
+            break;
+        }
+        if (vals[var]) {
+            continue;
+        }
+        int v = var;
+        auto pos = occurrences(v);
+        auto neg = occurrences(-v);
+        //a pure literal is always eliminated, as it has no resolvents
+        if (!pos.empty() && !neg.empty() && pos.size() + neg.size() > maxOccurrences) {
+            continue;
+        }
+        resolvents.clear();
+        bool gate = definition(clauses, v, pos, neg, gp, gn);
+        bool bounded = true;
+        for (std::size_t i = 0; i < pos.size(); ++i) {
+            unsigned p = pos[i];
+            for (std::size_t j = 0; j < neg.size(); ++j) {
+                unsigned q = neg[j];
+                if ((gate && gp[i] == gn[j]) || !resolve(clauses[p], clauses[q], v, r)) {
+                    continue;
+                }
+                //only if the problem does not grow
+                if (r.size() > maxResolvent || resolvents.size() == pos.size() + neg.size()) {
+                    bounded = false;
+                    break;
+                }
+                resolvents.push_back(r);
+            }
+            if (!bounded) {
+                break;
+            }
+        }
+        if (!bounded) {
+            continue;
+        }
+        for (unsigned p : pos) {
+            stack.push_back({v, clauses[p]});
+            remove(p);
+        }
+        for (unsigned q : neg) {
+            stack.push_back({-v, clauses[q]});
+            remove(q);
+        }
+        gone[var] = true;
+        ++counts.eliminated;
+        changed = true;
+        for (auto& res : resolvents) {
+            add(std::move(res));
+        }
+        propagate();
+    }
+    return changed;
+}
+
+Problem Preprocessor::simplify() {
+    assert(!simplified);
+    simplified = true;
+    for (unsigned round = 0; round < maxRounds && !unsat; ++round) {
+        bool changed = propagate();
+        if (!unsat && substitute()) {
+            changed = true;
+            propagate();
+        }
+        if (!unsat && subsume()) {
+            changed = true;
+            propagate();
+        }
+        if (!unsat && probe()) {
+            changed = true;
+        }
+        if (!unsat && eliminate()) {
+            changed = true;
+        }
+        if (!changed) {
+            break;
+        }
+    }
+    Problem p;
+    p.addVariables(n);
+    if (unsat) {
+        p.addClause(nullptr, 0);
+        return p;
+    }
+    //fixed variables are reconstructed first, as later clauses on the
+    //stack may rely on their values; frozen ones stay as units
+    counts.fixed = trail.size();
+    for (int lit : trail) {
+        if (frozen[std::abs(lit)]) {
+            p.addClause({lit});
+        }
+        else {
+            stack.push_back({lit, {lit}});
+        }
+    }
+    std::size_t lits = 0;
+    for (std::size_t c = 0; c < clauses.size(); ++c) {
+        lits += clauses[c].size();
+    }
+    p.reserve(clauses.size(), lits);
+    for (std::size_t c = 0; c < clauses.size(); ++c) {
+        if (!dead[c]) {
+            p.addClause(clauses[c]);
+        }
+    }
+    return p;
+}
+
+Solution Preprocessor::reconstruct(const Solution& s) const {
+    if (!s) {
+        return s;
+    }
+    std::vector<bool> model(n+1);
+    for (unsigned i = 1; i <= n; ++i) {
+        model[i] = s[i];
+    }
+    //Each removed clause is made true by its witness if nothing else
+    //makes it true, latest first.  An eliminated variable is flipped at
+    //most once this way: its clauses of one sign can only all be true
+    //with it false if the resolvents are, and they are.
+    for (auto it = stack.rbegin(); it != stack.rend(); ++it) {
+        bool satisfied = std::any_of(it->clause.begin(), it->clause.end(), [&](int lit) {
+                return model[std::abs(lit)] == (lit > 0); });
+        if (!satisfied) {
+            model[std::abs(it->witness)] = it->witness > 0;
+        }
+    }
+    Solution ret(Solution::Status::SAT);
+    ret.count = n;
+    ret.bits.assign((n + 63) / 64, 0);
+    for (unsigned i = 1; i <= n; ++i) {
+        if (model[i]) {
+            ret.bits[(i-1) / 64] |= std::uint64_t(1) << ((i-1) % 64);
+        }
+    }
+    return ret;
+}
@@ -1,23 +1,45 @@
 #include <CXXSat/Sat.h>
+#include <CXXSat/SatBackend.h>
+#include <CXXSat/Argument.h>
 
 #include <sstream>
 #include <string>
 #include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include <atomic>
+#include <cassert>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <fstream>
+#include <unistd.h>
 
-//later do something a bit more flexible
-//dependency injection or something of the sort
-#include <minisat/core/Solver.h>
-#include <minisat/core/SolverTypes.h>
-
-void Problem::addClause(Clause c) {
-    //this is not the ideal way to keep track of this...
-    for (auto& x : c) {
-        unsigned y = (x >= 0) ? x : -x;
-        if (y > max_var) {
-            max_var = y;
+void Problem::addClause(const int* lits, std::size_t n) {
+    //or-ing the magnitudes bounds the largest from above within a factor
+    //of two without a branch per literal; only then look for the real one
+    unsigned bits = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        bits |= (unsigned)std::abs(lits[i]);
+    }
+    if (bits > max_var) {
+        for (std::size_t i = 0; i < n; ++i) {
+            max_var = std::max(max_var, (unsigned)std::abs(lits[i]));
         }
     }
-    clauses.push_back(std::move(c));
+    literals.insert(literals.end(), lits, lits + n);
+    offsets.push_back(literals.size());
+}
+
+void Problem::append(const Problem& p) {
+    std::size_t base = literals.size();
+    literals.insert(literals.end(), p.literals.begin(), p.literals.end());
+    offsets.reserve(offsets.size() + p.numClauses());
+    for (std::size_t i = 1; i < p.offsets.size(); ++i) {
+        offsets.push_back(base + p.offsets[i]);
+    }
+    addVariables(p.max_var);
 }
 
 std::string Problem::toDIMACS() const {
@@ -27,9 +49,9 @@ std::string Problem::toDIMACS() const {
 }
 
 void Problem::printDIMACS(std::ostream& s) const {
-    s << "p cnf " << max_var << ' ' << clauses.size() << '\n';
-    for (auto& clause : clauses) {
-        for (auto& lit : clause) {
+    s << "p cnf " << max_var << ' ' << numClauses() << '\n';
+    for (auto clause : *this) {
+        for (auto lit : clause) {
             s << lit << ' ';
         }
         s << "0\n";
@@ -37,42 +59,388 @@ void Problem::printDIMACS(std::ostream& s) const {
 }
 
 Solution Problem::solve(bool debug) const {
-    Minisat::Solver s;
-    Minisat::vec<Minisat::Lit> lits;
-    for (auto& clause : clauses) {
-        for (auto& var_in : clause) {
-            int var = ((var_in > 0) ? var_in : -var_in) - 1;
-            while (var >= s.nVars()) {
-                s.newVar();
+    return solve(*SatBackend::create(), SolveLimits(), debug);
+}
+
+Solution Problem::solve(const SolveLimits& limits) const {
+    return solve(*SatBackend::create(), limits);
+}
+
+void Problem::load(SatBackend& s) const {
+    for (auto clause : *this) {
+        s.addClause(clause.begin(), clause.size());
+    }
+}
+
+Solution Problem::solve(SatBackend& s, bool debug) const {
+    return solve(s, SolveLimits(), debug);
+}
+
+Solution Problem::solve(SatBackend& s, const SolveLimits& limits, bool debug) const {
+    load(s);
+    int result;
+    {
+        SolveLimits::Guard guard(limits, s);
+        result = s.solve();
+    }
+    if (result != SatBackend::SAT) {
+        return Solution((result == SatBackend::UNSAT) ?
+                Solution::Status::UNSAT : Solution::Status::UNKNOWN);
+    }
+    auto solution = Solution::model(s, max_var, projection);
+    if (debug) {
+        for (unsigned i = 1; i <= max_var; ++i) {
+            std::cout << (solution[i] ? (int)i : -(int)i) << ' ';
+        }
+        std::cout << '\n';
+    }
+    return solution;
+}
+
+Solution Problem::solveParallel(unsigned threads,
+        const std::vector<std::string>& names, const SolveLimits& limits) const
+{
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    //made up front, so that the winner can interrupt all of them
+    std::vector<std::unique_ptr<SatBackend>> backends;
+    for (unsigned i = 0; i < threads; ++i) {
+        const auto& name = names.empty() ? SatBackend::getDefault() : names[i % names.size()];
+        backends.push_back(SatBackend::create(name));
+        //copies of one backend each get their own settings
+        backends.back()->diversify(names.empty() ? i : i / names.size());
+    }
+    std::mutex m;
+    bool done = false;
+    Solution solution;
+    auto run = [&](SatBackend& s) {
+        load(s);
+        SolveLimits::Guard guard(limits, s);
+        int result = s.solve();
+        if (result == SatBackend::UNKNOWN) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m);
+        if (done) {
+            return;
+        }
+        done = true;
+        if (result == SatBackend::SAT) {
+            solution = Solution::model(s, max_var, projection);
+        }
+        for (auto& other : backends) {
+            if (other.get() != &s) {
+                other->interrupt();
             }
-            lits.push((var_in > 0) ?
-                   Minisat::mkLit(var) :
-                   ~Minisat::mkLit(var));
         }
-        s.addClause(lits);
-        lits.clear();
-    }
-    //perhaps use solveLimited here for resource constraints later
-    if (s.simplify() && s.solve()) {
-        auto solution = std::make_unique<std::unordered_map<int, bool>>();
-        for (int i = 0; i < s.nVars();) {
-            if (s.model[i] != Minisat::l_Undef) {
-                //Note the ++ in this - to avoid off-by-one errors
-                if (s.model[i] != Minisat::l_True) {
-                    solution->insert({++i, false});
-                    if (debug) std::cout << -i << ' ';
+    };
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads; ++i) {
+        pool.emplace_back(run, std::ref(*backends[i]));
+    }
+    run(*backends[0]);
+    for (auto& t : pool) {
+        t.join();
+    }
+    //every solver gave up
+    if (!done) {
+        return Solution(Solution::Status::UNKNOWN);
+    }
+    return solution;
+}
+
+Solution Problem::solveCubes(const std::vector<int>& vars, unsigned threads,
+        const std::function<void(std::size_t, std::size_t)>& progress,
+        const SolveLimits& limits) const
+{
+    assert(vars.size() < 8*sizeof(std::size_t));
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::vector<std::unique_ptr<SatBackend>> backends;
+    for (unsigned i = 0; i < threads; ++i) {
+        backends.push_back(SatBackend::create());
+    }
+    const std::size_t cubes = std::size_t(1) << vars.size();
+    //cubes are handed out in order to whichever solver is free
+    std::atomic<std::size_t> next{0};
+    std::mutex m;
+    bool found = false;
+    bool gave_up = false;
+    std::size_t refuted = 0;
+    Solution solution;
+    auto run = [&](SatBackend& s) {
+        load(s);
+        SolveLimits::Guard guard(limits, s);
+        for (std::size_t cube; (cube = next++) < cubes;) {
+            //the interrupt only stops one solve, but time and memory
+            //limits hold for the whole call
+            if (guard.expired()) {
+                std::lock_guard<std::mutex> lock(m);
+                gave_up = true;
+                return;
+            }
+            for (std::size_t i = 0; i < vars.size(); ++i) {
+                s.assume(((cube >> i) & 1) ? vars[i] : -vars[i]);
+            }
+            int result = s.solve();
+            std::lock_guard<std::mutex> lock(m);
+            if (found) {
+                return;
+            }
+            //another cube may still be satisfiable, unless time is up
+            if (result == SatBackend::UNKNOWN) {
+                gave_up = true;
+                if (limits.cancelled() || guard.expired()) {
+                    return;
+                }
+                continue;
+            }
+            if (result == SatBackend::SAT) {
+                found = true;
+                solution = Solution::model(s, max_var, projection);
+                for (auto& other : backends) {
+                    if (other.get() != &s) {
+                        other->interrupt();
+                    }
+                }
+                return;
+            }
+            ++refuted;
+            if (progress) {
+                progress(refuted, cubes);
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads; ++i) {
+        pool.emplace_back(run, std::ref(*backends[i]));
+    }
+    run(*backends[0]);
+    for (auto& t : pool) {
+        t.join();
+    }
+    if (!found && gave_up) {
+        return Solution(Solution::Status::UNKNOWN);
+    }
+    return solution;
+}
+
+std::size_t Problem::enumerate(std::vector<int> vars, std::size_t limit,
+        const std::function<void(const Solution&)>& found, unsigned threads,
+        const SolveLimits& limits, bool* complete) const
+{
+    std::sort(vars.begin(), vars.end());
+    vars.erase(std::unique(vars.begin(), vars.end()), vars.end());
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::vector<std::unique_ptr<SatBackend>> backends;
+    for (unsigned i = 0; i < threads; ++i) {
+        backends.push_back(SatBackend::create());
+    }
+    //a few cubes per thread, so none sits idle while others finish
+    unsigned k = 0;
+    while (threads > 1 && k < vars.size() && (1u << k) < 4*threads) {
+        ++k;
+    }
+    const std::size_t cubes = std::size_t(1) << k;
+    std::atomic<std::size_t> next{0};
+    std::mutex m;
+    std::size_t count = 0;
+    bool stop = false;
+    bool gave_up = false;
+    auto run = [&](SatBackend& s) {
+        load(s);
+        SolveLimits::Guard guard(limits, s);
+        std::vector<int> block(vars.size());
+        for (std::size_t cube; (cube = next++) < cubes;) {
+            for (;;) {
+                //as in solveCubes, the time and memory limits hold for
+                //the whole call, not just the solve they interrupt
+                if (guard.expired()) {
+                    std::lock_guard<std::mutex> lock(m);
+                    gave_up = true;
+                    return;
+                }
+                for (unsigned i = 0; i < k; ++i) {
+                    s.assume(((cube >> i) & 1) ? vars[i] : -vars[i]);
                 }
-                else {
-                    solution->insert({++i, true});
-                    if (debug) std::cout << i << ' ';
+                int result = s.solve();
+                if (result == SatBackend::UNKNOWN) {
+                    std::lock_guard<std::mutex> lock(m);
+                    //interrupted because the limit was reached
+                    if (stop) {
+                        return;
+                    }
+                    //the rest of this cube is lost, but others may finish
+                    gave_up = true;
+                    if (limits.cancelled() || guard.expired()) {
+                        return;
+                    }
+                    break;
                 }
+                if (result == SatBackend::UNSAT) {
+                    break;
+                }
+                //the blocking clause also rules it out of later cubes,
+                //which it cannot be in anyway
+                for (std::size_t i = 0; i < vars.size(); ++i) {
+                    block[i] = s.value(vars[i]) ? -vars[i] : vars[i];
+                }
+                s.addClause(block.data(), block.size());
+                std::lock_guard<std::mutex> lock(m);
+                if (stop) {
+                    return;
+                }
+                ++count;
+                found(Solution::model(s, 0, vars));
+                if (limit && count == limit) {
+                    stop = true;
+                    for (auto& other : backends) {
+                        other->interrupt();
+                    }
+                    return;
+                }
+            }
+            std::lock_guard<std::mutex> lock(m);
+            if (stop) {
+                return;
             }
         }
-        if (debug) std::cout << '\n';
-        return Solution(std::move(solution));
+    };
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads; ++i) {
+        pool.emplace_back(run, std::ref(*backends[i]));
     }
-    else {
-        return {};
+    run(*backends[0]);
+    for (auto& t : pool) {
+        t.join();
     }
+    if (complete) {
+        *complete = stop || !gave_up;
+    }
+    return count;
+}
+
+std::size_t Problem::enumerate(const std::vector<Argument>& args, std::size_t limit,
+        const std::function<void(const Solution&)>& found, unsigned threads,
+        const SolveLimits& limits, bool* complete) const
+{
+    std::vector<int> vars;
+    for (auto& arg : args) {
+        auto v = arg.variables();
+        vars.insert(vars.end(), v.begin(), v.end());
+    }
+    return enumerate(std::move(vars), limit, found, threads, limits, complete);
 }
 
+Solution Solution::model(const SatBackend& s, unsigned n, const std::vector<int>& projection) {
+    Solution ret(Status::SAT);
+    ret.vars = projection;
+    ret.count = projection.empty() ? n : projection.size();
+    ret.bits.assign((ret.count + 63) / 64, 0);
+    for (std::size_t k = 0; k < ret.count; ++k) {
+        int var = projection.empty() ? (int)k + 1 : projection[k];
+        if (s.value(var)) {
+            ret.bits[k / 64] |= std::uint64_t(1) << (k % 64);
+        }
+    }
+    return ret;
+}
+
+class SolveLimits::Guard::Watchdog {
+public:
+    Watchdog(const SolveLimits& l, SatBackend& b) {
+        thread = std::thread([this, &l, &b] { watch(l, b); });
+    }
+    ~Watchdog() {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            done = true;
+        }
+        wake.notify_all();
+        thread.join();
+    }
+    //set for good once a limit is reached
+    std::atomic<bool> expired{false};
+private:
+    std::mutex m;
+    std::condition_variable wake;
+    bool done = false;
+    std::thread thread;
+
+    //bytes resident, or 0 if unknown
+    static std::size_t resident() {
+        std::ifstream statm("/proc/self/statm");
+        std::size_t size, pages;
+        if (statm >> size >> pages) {
+            return pages * sysconf(_SC_PAGESIZE);
+        }
+        return 0;
+    }
+    void watch(const SolveLimits& l, SatBackend& b) {
+        using clock = std::chrono::steady_clock;
+        auto deadline = clock::now() + std::chrono::duration_cast<clock::duration>(
+                std::chrono::duration<double>(l.seconds));
+        std::unique_lock<std::mutex> lock(m);
+        while (!done) {
+            auto next = deadline;
+            //memory has to be polled
+            auto poll = clock::now() + std::chrono::milliseconds(100);
+            if (l.memory && (l.seconds <= 0 || poll < deadline)) {
+                next = poll;
+            }
+            wake.wait_until(lock, next);
+            if (done) {
+                return;
+            }
+            if ((l.seconds > 0 && clock::now() >= deadline) || (l.memory && resident() > l.memory)) {
+                expired = true;
+                b.interrupt();
+                return;
+            }
+        }
+    }
+};
+
+void SolveLimits::cancel() {
+    stopped = true;
+    std::lock_guard<std::mutex> lock(m);
+    for (auto backend : running) {
+        backend->interrupt();
+    }
+}
+
+SolveLimits::Guard::Guard(const SolveLimits& l, SatBackend& b) : limits(l), backend(b) {
+    backend.limitConflicts(limits.conflicts);
+    backend.limitPropagations(limits.propagations);
+    {
+        std::lock_guard<std::mutex> lock(limits.m);
+        limits.running.push_back(&backend);
+    }
+    //checked after registering, so a concurrent cancel() can't be missed
+    if (limits.stopped) {
+        backend.interrupt();
+    }
+    if (limits.seconds > 0 || limits.memory) {
+        watchdog.reset(new Watchdog(limits, backend));
+    }
+}
+
+bool SolveLimits::Guard::expired() const {
+    return watchdog && watchdog->expired;
+}
+
+SolveLimits::Guard::~Guard() {
+    watchdog.reset();
+    {
+        std::lock_guard<std::mutex> lock(limits.m);
+        auto it = std::find(limits.running.begin(), limits.running.end(), &backend);
+        limits.running.erase(it);
+    }
+    backend.clearInterrupt();
+    backend.limitConflicts(-1);
+    backend.limitPropagations(-1);
+}
@@ -0,0 +1,208 @@
+#include <CXXSat/SatBackend.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <cstdlib>
+#include <dlfcn.h>
+
+#include <minisat/core/Solver.h>
+#include <minisat/core/SolverTypes.h>
+
+namespace {
+
+class MinisatBackend final : public SatBackend {
+public:
+    std::string name() const override {
+        return "minisat";
+    }
+    void addClause(const int* lits, std::size_t n) override {
+        clause.clear();
+        for (std::size_t i = 0; i < n; ++i) {
+            clause.push(lit(lits[i]));
+        }
+        solver.addClause_(clause);
+    }
+    void assume(int x) override {
+        assumptions.push(lit(x));
+    }
+    int solve() override {
+        solver.budgetOff();
+        if (conflicts >= 0) {
+            solver.setConfBudget(conflicts);
+        }
+        if (propagations >= 0) {
+            solver.setPropBudget(propagations);
+        }
+        auto result = solver.simplify() ? solver.solveLimited(assumptions) : Minisat::l_False;
+        assumptions.clear();
+        solver.clearInterrupt();
+        if (result == Minisat::l_True) return SAT;
+        if (result == Minisat::l_False) return UNSAT;
+        return UNKNOWN;
+    }
+    bool value(int var) const override {
+        return var <= solver.model.size() && solver.model[var - 1] == Minisat::l_True;
+    }
+    unsigned numVars() const override {
+        return solver.nVars();
+    }
+    void limitConflicts(std::int64_t n) override {
+        conflicts = n;
+    }
+    void limitPropagations(std::int64_t n) override {
+        propagations = n;
+    }
+    void interrupt() override {
+        solver.interrupt();
+    }
+    void clearInterrupt() override {
+        solver.clearInterrupt();
+    }
+    void diversify(unsigned n) override {
+        if (n == 0) {
+            return;
+        }
+        solver.random_seed = 91648253.0 + 7919.0*n;
+        //geometric rather than Luby restarts
+        if (n % 2) {
+            solver.luby_restart = false;
+            solver.restart_first = 100;
+            solver.restart_inc = 1.5;
+        }
+        //no phase saving, or only within a restart's last decisions
+        if (n % 3) {
+            solver.phase_saving = n % 3 - 1;
+        }
+        //random decisions and initial activities now and then
+        if (n % 4 == 3) {
+            solver.rnd_init_act = true;
+            solver.random_var_freq = 0.02;
+        }
+    }
+private:
+    Minisat::Solver solver;
+    Minisat::vec<Minisat::Lit> clause;
+    Minisat::vec<Minisat::Lit> assumptions;
+    std::int64_t conflicts = -1;
+    std::int64_t propagations = -1;
+
+    Minisat::Lit lit(int x) {
+        int var = std::abs(x) - 1;
+        while (var >= solver.nVars()) {
+            solver.newVar();
+        }
+        return (x > 0) ? Minisat::mkLit(var) : ~Minisat::mkLit(var);
+    }
+};
+
+//Any solver implementing IPASIR, loaded from a shared library with dlopen
+//so the library need not be linked against it.
+class IpasirBackend final : public SatBackend {
+public:
+    explicit IpasirBackend(const std::string& path) {
+        handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (!handle) {
+            throw std::invalid_argument("Cannot load IPASIR solver " + path + ": " + dlerror());
+        }
+        load(signature, "ipasir_signature");
+        load(init, "ipasir_init");
+        load(release, "ipasir_release");
+        load(add, "ipasir_add");
+        load(assume_, "ipasir_assume");
+        load(solve_, "ipasir_solve");
+        load(val, "ipasir_val");
+        load(set_terminate, "ipasir_set_terminate");
+        solver = init();
+        set_terminate(solver, this, &IpasirBackend::terminate);
+    }
+    IpasirBackend(const IpasirBackend&) = delete;
+    ~IpasirBackend() {
+        release(solver);
+        dlclose(handle);
+    }
+    std::string name() const override {
+        return std::string("ipasir:") + signature();
+    }
+    void addClause(const int* lits, std::size_t n) override {
+        for (std::size_t i = 0; i < n; ++i) {
+            use(lits[i]);
+            add(solver, lits[i]);
+        }
+        add(solver, 0);
+    }
+    void assume(int lit) override {
+        use(lit);
+        assume_(solver, lit);
+    }
+    int solve() override {
+        int result = solve_(solver);
+        stop = false;
+        return result;
+    }
+    bool value(int var) const override {
+        return (unsigned)var <= vars && val(solver, var) > 0;
+    }
+    unsigned numVars() const override {
+        return vars;
+    }
+    void interrupt() override {
+        stop = true;
+    }
+    void clearInterrupt() override {
+        stop = false;
+    }
+private:
+    void* handle = nullptr;
+    void* solver = nullptr;
+    unsigned vars = 0;
+    std::atomic<bool> stop{false};
+    const char* (*signature)();
+    void* (*init)();
+    void (*release)(void*);
+    void (*add)(void*, int);
+    void (*assume_)(void*, int);
+    int (*solve_)(void*);
+    int (*val)(void*, int);
+    void (*set_terminate)(void*, void*, int (*)(void*));
+
+    template <class F>
+    void load(F& f, const char* symbol) {
+        f = reinterpret_cast<F>(dlsym(handle, symbol));
+        if (!f) {
+            dlclose(handle);
+            throw std::invalid_argument(std::string("IPASIR solver lacks ") + symbol);
+        }
+    }
+    void use(int lit) {
+        unsigned var = std::abs(lit);
+        if (var > vars) {
+            vars = var;
+        }
+    }
+    static int terminate(void* self) {
+        return static_cast<IpasirBackend*>(self)->stop.load();
+    }
+};
+
+std::string default_backend = "minisat";
+
+}
+
+std::unique_ptr<SatBackend> SatBackend::create(const std::string& name) {
+    if (name == "minisat") {
+        return std::make_unique<MinisatBackend>();
+    }
+    const std::string ipasir = "ipasir:";
+    if (name.compare(0, ipasir.size(), ipasir) == 0) {
+        return std::make_unique<IpasirBackend>(name.substr(ipasir.size()));
+    }
+    throw std::invalid_argument("Unknown SAT backend " + name);
+}
+
+const std::string& SatBackend::getDefault() {
+    return default_backend;
+}
+
+void SatBackend::setDefault(const std::string& name) {
+    default_backend = name;
+}
@@ -0,0 +1,122 @@
+#include <CXXSat/SolverSession.h>
+#include <CXXSat/Variable.h>
+
+#include "CircuitImpl.h"
+
+class SolverSession::Sink : public ClauseSink {
+public:
+    explicit Sink(SolverSession& s) : session(s) {}
+    void addClause(const int* lits, std::size_t n) override {
+        session.addClause(lits, n);
+    }
+private:
+    SolverSession& session;
+};
+
+SolverSession::SolverSession(const Circuit& c, std::unique_ptr<SatBackend> s)
+    : circuit{c.getPimpl().lock()}, solver{std::move(s)}
+{
+    assert(circuit && solver);
+}
+
+SolverSession::~SolverSession() = default;
+
+int SolverSession::literal(const Variable& v) {
+    auto bit = (v.isBit() ? v : v.asBit()).bits[0];
+    encode(bit.source());
+    return bit.getID();
+}
+
+void SolverSession::require(const Variable& v) {
+    int lit = literal(v);
+    addClause(&lit, 1);
+}
+
+Solution SolverSession::solve(const Variable& v, const SolveLimits& limits) {
+    return solve(std::vector<int>{literal(v)}, limits);
+}
+
+Solution SolverSession::solve(const std::vector<int>& assumptions, const SolveLimits& limits) {
+    restore();
+    for (auto lit : assumptions) {
+        solver->assume(lit);
+    }
+    int result;
+    {
+        SolveLimits::Guard guard(limits, *solver);
+        result = solver->solve();
+    }
+    if (result != SatBackend::SAT) {
+        return Solution((result == SatBackend::UNSAT) ?
+                Solution::Status::UNSAT : Solution::Status::UNKNOWN);
+    }
+    return Solution::model(*solver, numVars(), {});
+}
+
+int SolverSession::number(const std::shared_ptr<Circuit::Wire>& w) {
+    auto it = ids.find(w);
+    if (it != ids.end()) {
+        return it->second;
+    }
+    int id = w->setID(next) ? next++ : 0;
+    ids.emplace(w, id);
+    //another session on the circuit may have numbered it, and must
+    //restore its own number, while this one runs with all of its in place
+    if (id) {
+        numbered = ++circuit->numbering;
+    }
+    //the circuit's constants are pinned as soon as they are used
+    if (id && w->literal() >= 0) {
+        int unit = w->literal() ? id : -id;
+        addClause(&unit, 1);
+    }
+    return id;
+}
+
+void SolverSession::restore() {
+    if (numbered == circuit->numbering) {
+        return;
+    }
+    for (auto& wire : ids) {
+        if (wire.second) {
+            wire.first->setID(wire.second);
+        }
+    }
+    //an argument's bits are decoded whether or not the targets use them
+    for (auto wire : circuit->wires) {
+        if (wire->source()->isInput()) {
+            number(wire->source()->asInput()->getWire());
+        }
+    }
+    numbered = circuit->numbering;
+}
+
+void SolverSession::encode(const std::shared_ptr<Circuit::Wire>& target) {
+    restore();
+    //the gates the target needs that the solver has not been given
+    std::vector<Circuit::Gate*> order;
+    std::vector<std::shared_ptr<Circuit::Wire>> stack{target};
+    while (!stack.empty()) {
+        auto wire = std::move(stack.back());
+        stack.pop_back();
+        number(wire);
+        auto node = wire->source().get();
+        if (!node->isGate() || !encoded.insert(node->asGate()).second) {
+            continue;
+        }
+        auto gate = node->asGate();
+        order.push_back(gate);
+        for (unsigned i = 0; i < gate->numInputs(); ++i) {
+            stack.push_back(gate->getInput(i));
+        }
+    }
+    Sink sink(*this);
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        (*it)->emplaceCNF(sink);
+    }
+}
+
+void SolverSession::addClause(const int* lits, std::size_t n) {
+    solver->addClause(lits, n);
+    ++clauses;
+}
@@ -1,13 +1,21 @@
 #include <CXXSat/Variable.h>
 #include <CXXSat/Circuit.h>
 #include <CXXSat/Argument.h>
+#include <CXXSat/Adders.h>
 
 CastMode::mode_t CastMode::mode = CastMode::C_STYLE;
 
+//bit patterns, least significant first
+typedef std::vector<bool> bitvec;
+
 Variable::Variable(const Argument& arg) : 
-    circuit{arg.getCircuit()}, bits{make_vector([&arg](std::size_t i) {
-                return Circuit::Value(*(arg.getInputs().at(i)));
-    }, arg.size())}, is_signed{arg.sign()} {}
+    circuit{arg.getCircuit()}, is_signed{arg.sign()}
+{
+    bits.reserve(arg.size());
+    for (const auto& i : arg.getInputs()) {
+        bits.emplace_back(*i);
+    }
+}
 
 Variable::Variable(const Variable& var) : 
     circuit{var.getCircuit()}, bits{var.bits}, is_signed{var.sign()} {}
@@ -35,13 +43,261 @@ Variable& Variable::operator=(Variable&& other) {
     return *this;
 }
 
+bool Variable::isConstant() const {
+    return std::all_of(begin(bits), end(bits), [](const Circuit::Value& v) {
+        return v.isLiteral();
+    });
+}
+
+std::vector<bool> Variable::constant_bits() const {
+    assert(isConstant());
+    std::vector<bool> ret(size());
+    for (unsigned i = 0; i < size(); ++i) {
+        ret[i] = bits[i].literalValue();
+    }
+    return ret;
+}
+
+unsigned Variable::unsignedWidth() const {
+    unsigned n = size();
+    while (n > 0 && bits[n-1].isLiteral() && !bits[n-1].literalValue()) {
+        --n;
+    }
+    return n;
+}
+
+unsigned Variable::signedWidth() const {
+    unsigned n = size();
+    while (n > 1 && repeats(n-1)) {
+        --n;
+    }
+    return n;
+}
+
+TypeInfo Variable::narrowest(const Variable& a, const Variable& b, unsigned extra) {
+    return narrowest(std::max(a.unsignedWidth(), b.unsignedWidth()),
+            std::max(a.signedWidth(), b.signedWidth()), extra, a.getTypeInfo());
+}
+
+TypeInfo Variable::narrowest(unsigned u, unsigned s, unsigned extra, TypeInfo own) {
+    //an unsigned operand sign extended from fewer bits has a different
+    //value as that signed type, and only the low bits of its products
+    //and sums would survive; full products need the exact value
+    TypeInfo info = (u <= s || !own.sign()) ? TypeInfo(false, u + extra) : TypeInfo(true, s + extra);
+    //keep clear of single bits, which the casts treat as booleans
+    if (info.size() < 2) {
+        info = TypeInfo(info.sign(), 2);
+    }
+    return (info.size() < own.size()) ? info : own;
+}
+
+//The smallest and largest values the known bits allow, as bit patterns.
+//An unknown sign bit is 1 at the bottom of a signed range and 0 at the
+//top.  Repeated bits are treated as independent, which only loosens the
+//bounds.
+static void bounds(const Variable& v, bitvec& lo, bitvec& hi) {
+    auto bits = v.view();
+    unsigned n = bits.size();
+    lo.assign(n, false);
+    hi.assign(n, true);
+    for (unsigned i = 0; i < n; ++i) {
+        if (bits[i].isLiteral()) {
+            lo[i] = hi[i] = bits[i].literalValue();
+        }
+    }
+    if (v.sign() && !bits[n-1].isLiteral()) {
+        lo[n-1] = true;
+        hi[n-1] = false;
+    }
+}
+
+static bool bv_less(const bitvec& a, const bitvec& b, bool sign) {
+    unsigned n = a.size();
+    if (sign && a[n-1] != b[n-1]) {
+        return a[n-1];
+    }
+    for (int i = n - 1; i >= 0; --i) {
+        if (a[i] != b[i]) {
+            return b[i];
+        }
+    }
+    return false;
+}
+
+bool Variable::known_less(const Variable& a, const Variable& b, bool& result) {
+    bitvec alo, ahi, blo, bhi;
+    bounds(a, alo, ahi);
+    bounds(b, blo, bhi);
+    if (bv_less(ahi, blo, a.sign())) {
+        result = true;
+        return true;
+    }
+    if (!bv_less(alo, bhi, a.sign())) {
+        result = false;
+        return true;
+    }
+    return false;
+}
+
+TypeInfo Variable::converted(TypeInfo a, TypeInfo b) {
+    unsigned op_size = std::max(a.size(), b.size());
+    bool op_sign;
+    if (a.sign() == b.sign()) {
+        op_sign = a.sign();
+    }
+    else {
+        //signedness differs
+        if (a.size() == b.size()) {
+            op_sign = false; //unsigned prevails if sizes equal
+        }
+        else {
+            op_sign = ((a.size() > b.size()) ? a : b).sign();
+        }
+    }
+    //however, all of that said:
+    if (CastMode::get() == CastMode::C_STYLE && op_size < int_size) {
+        //all values are converted to int
+        op_size = int_size;
+        op_sign = true;
+    }
+    return TypeInfo(op_sign, op_size);
+}
+
+bool Variable::foldable(TypeInfo info) {
+    switch (info.size()) {
+    case 8:
+    case 16:
+    case 32:
+    case 64:
+        return true;
+    default:
+        return false;
+    }
+}
+
+FlexInt Variable::constant_value() const {
+    assert(isConstant() && foldable(getTypeInfo()));
+    uint64_t x = 0;
+    for (unsigned i = 0; i < size(); ++i) {
+        x |= (uint64_t)bits[i].literalValue() << i;
+    }
+    return FlexInt(x).cast(getTypeInfo());
+}
+
+//Wrapping arithmetic is done on the two's complement bits as a uint64_t,
+//since overflowing the host's signed types is undefined.
+static uint64_t bits64(const FlexInt& x) {
+    return x.cast(TypeInfo(false, 64)).as<uint64_t>();
+}
+
+static FlexInt wrap(uint64_t x, TypeInfo info) {
+    return FlexInt(x).cast(info);
+}
+
+bool Variable::foldable(Variable (&op)(const Variable&, const Variable&),
+        const FlexInt& x, const FlexInt& y)
+{
+    auto n = x.getTypeInfo().size();
+    if (&op == &Shl_ || &op == &Shr_) {
+        //the circuit defines out of range shifts, C doesn't
+        auto k = y.as<int64_t>();
+        return k >= 0 && k < n;
+    }
+    if (&op == &Mul_full_) {
+        return n <= 32;
+    }
+    return &op == &And_ || &op == &Nand_ || &op == &Or_ || &op == &Nor_ ||
+        &op == &Xor_ || &op == &Xnor_ || &op == &Add_ || &op == &Sub_ ||
+        &op == &Mul_ || &op == &Less_ || &op == &Equal_;
+}
+
+Variable Variable::fold(Variable (&op)(const Variable&, const Variable&),
+        const FlexInt& x, const FlexInt& y, const std::weak_ptr<Circuit::impl>& c)
+{
+    auto info = x.getTypeInfo();
+    auto a = bits64(x);
+    auto b = bits64(y);
+    if (&op == &Less_) {
+        return Circuit::getLiteralBit(c, x < y);
+    }
+    if (&op == &Equal_) {
+        return Circuit::getLiteralBit(c, x == y);
+    }
+    if (&op == &Mul_full_) {
+        TypeInfo wide(info.sign(), info.size()*2);
+        return getLiteral(wrap(bits64(x.cast(wide)) * bits64(y.cast(wide)), wide), c);
+    }
+    if (&op == &Shr_) {
+        return getLiteral((x >> y).cast(info), c);
+    }
+    uint64_t r;
+    if (&op == &And_) r = a & b;
+    else if (&op == &Nand_) r = ~(a & b);
+    else if (&op == &Or_) r = a | b;
+    else if (&op == &Nor_) r = ~(a | b);
+    else if (&op == &Xor_) r = a ^ b;
+    else if (&op == &Xnor_) r = ~(a ^ b);
+    else if (&op == &Add_) r = a + b;
+    else if (&op == &Sub_) r = a - b;
+    else if (&op == &Mul_) r = a * b;
+    else if (&op == &Shl_) r = a << b;
+    else {
+        assert(false);
+        r = 0;
+    }
+    return getLiteral(wrap(r, info), c);
+}
+
+bool Variable::foldable(Comparison (&)(const Variable&, const Variable&),
+        const FlexInt&, const FlexInt&)
+{
+    return true;
+}
+
+Variable::Comparison Variable::fold(Comparison (&)(const Variable&, const Variable&),
+        const FlexInt& x, const FlexInt& y, const std::weak_ptr<Circuit::impl>& c)
+{
+    return {Circuit::getLiteralBit(c, x < y), Circuit::getLiteralBit(c, x == y),
+        Circuit::getLiteralBit(c, x > y)};
+}
+
+bool Variable::foldable(void (&)(const Variable&, const Variable&, Variable*, Variable*),
+        const FlexInt& x, const FlexInt& y, Variable*, Variable*)
+{
+    auto info = x.getTypeInfo();
+    bool min = (bits64(x) << (64 - info.size())) == (uint64_t)1 << 63;
+    return (bool)y && !(info.sign() && min && bits64(y) == ~(uint64_t)0);
+}
+
+void Variable::fold(void (&)(const Variable&, const Variable&, Variable*, Variable*),
+        const FlexInt& x, const FlexInt& y, const std::weak_ptr<Circuit::impl>& c,
+        Variable* quot, Variable* rem)
+{
+    if (quot) {
+        quot->overwrite(getLiteral((x / y).cast(x.getTypeInfo()), c));
+    }
+    if (rem) {
+        rem->overwrite(getLiteral((x % y).cast(x.getTypeInfo()), c));
+    }
+}
+
+bool Variable::foldable(Variable (&)(const Variable&, const Variable&, const Variable&),
+        const FlexInt&, const FlexInt&, const Variable& cond)
+{
+    return cond.isConstant();
+}
+
+Variable Variable::fold(Variable (&)(const Variable&, const Variable&, const Variable&),
+        const FlexInt& x, const FlexInt& y, const std::weak_ptr<Circuit::impl>& c,
+        const Variable& cond)
+{
+    auto k = cond.constant_bits();
+    return getLiteral(std::find(begin(k), end(k), true) != end(k) ? x : y, c);
+}
+
 Variable Variable::generateMask(const Variable& v, TypeInfo info) {
     const auto& b = v.isBit() ? v : v.asBit();
-    Variable x(b.getCircuit(), info);
-    for (auto& bit : x.bits) {
-        bit = b.bits[0];
-    }
-    return std::move(x);
+    return Variable(b.getCircuit(), BitView::fill(b.bits[0], info.size()), info.sign());
 }
 
 Variable Variable::generateMask(const Variable& v) const {
@@ -50,47 +306,96 @@ Variable Variable::generateMask(const Variable& v) const {
 
 Variable Variable::Not(const Variable& a) {
     Variable x(a.getCircuit(), a.getTypeInfo());
-    std::transform(begin(a.bits), end(a.bits), begin(x.bits),
-        [](const Circuit::Value& v) {
-            return ::Not(v);
-        }
-    );
+    for (unsigned i = 0; i < a.size(); ++i) {
+        x.bits[i] = a.repeats(i) ? x.bits[i-1] : ::Not(a.bits[i]);
+    }
     return std::move(x);                
 };
 
 Variable Variable::Equal_(const Variable& a, const Variable& b) {
     assert(a.getTypeInfo() == b.getTypeInfo());
-    const auto& i = Xnor(a, b);
-    return Variable(::MultiAnd(i.bits));
+    auto info = narrowest(a, b, 0);
+    if ((unsigned)info.size() < a.size()) {
+        return Equal_(a.cast(info), b.cast(info));
+    }
+    //against a constant, each bit is either the input or its inverse, so
+    //x == 5 is a single MultiAnd over the (possibly inverted) bits of x
+    std::vector<Circuit::Value> matches;
+    matches.reserve(a.size());
+    for (unsigned i = 0; i < a.size(); ++i) {
+        const auto& x = a.bits[i];
+        const auto& y = b.bits[i];
+        if (x.isLiteral() && y.isLiteral()) {
+            if (x.literalValue() != y.literalValue()) {
+                return Variable(Circuit::getLiteralFalse(a.getCircuit()));
+            }
+        }
+        else if (x.isLiteral()) {
+            matches.push_back(x.literalValue() ? y : ::Not(y));
+        }
+        else if (y.isLiteral()) {
+            matches.push_back(y.literalValue() ? x : ::Not(x));
+        }
+        else {
+            matches.push_back(::Xnor(x, y));
+        }
+    }
+    if (matches.empty()) {
+        return Variable(Circuit::getLiteralTrue(a.getCircuit()));
+    }
+    return Variable(::MultiAnd(matches));
 }
 
 Variable Variable::NotEq(const Variable& a, const Variable& b) {
     return !Equal(a, b);
 }
 
-Variable Variable::Less_(const Variable& a, const Variable& b) {
+Circuit::Value Variable::less_than(const Variable& a, const Variable& b) {
     assert(a.getTypeInfo() == b.getTypeInfo());
-    Circuit::Value carry_out;
-    //subtract *this - t, get the carry
-    auto comparison = do_addition(a, ~b, true, &carry_out);
-    if (a.sign()) {
-        //if signed, have to do a carry computation for the sign bits:
-        auto extra_bit = ::Xor(a.bits[a.size()-1], ::Not(b.bits[b.size()-1]));
-        return Variable(::Xor(extra_bit, carry_out));
+    //a < b exactly when a - b = a + ~b + 1 does not carry out, so only the
+    //adder's carry network is kept (with a ripple adder, a chain of
+    //majority gates).  Flipping both sign bits maps signed order onto
+    //unsigned order.
+    bool known;
+    if (known_less(a, b, known)) {
+        return known ? Circuit::getLiteralTrue(a.getCircuit())
+            : Circuit::getLiteralFalse(a.getCircuit());
     }
-    else {
-        //if unsigned, a carry indicates the result of the subtraction is
-        //positive or zero, so *this >= t
-        return Variable(::Not(carry_out));
+    //extension preserves order, within either signedness
+    auto info = narrowest(a, b, 0);
+    if ((unsigned)info.size() < a.size()) {
+        info = TypeInfo(info.sign() && a.sign(), info.size());
+        return less_than(a.cast(info), b.cast(info));
     }
+    unsigned n = a.size();
+    Variable x = a;
+    Variable y = Not(b);
+    if (a.sign()) {
+        x.bits[n-1] = ::Not(x.bits[n-1]);
+        y.bits[n-1] = ::Not(y.bits[n-1]);
+    }
+    Circuit::Value carry;
+    do_addition(x, y, true, &carry);
+    return ::Not(carry);
+}
+
+Variable Variable::Less_(const Variable& a, const Variable& b) {
+    return Variable(less_than(a, b));
+}
+
+Variable::Comparison Variable::Compare_(const Variable& a, const Variable& b) {
+    auto lt = less_than(a, b);
+    auto eq = Equal_(a, b);
+    auto gt = ::Nor(lt, eq.bits[0]);
+    return {Variable(lt), std::move(eq), Variable(gt)};
 }
 
 Variable Variable::LessEq(const Variable& a, const Variable& b) {
-    return Less(a, b) | Equal(a, b);
+    return !Less(b, a);
 }
 
 Variable Variable::Greater(const Variable& a, const Variable& b) {
-    return !LessEq(a, b);
+    return Less(b, a);
 }
 
 Variable Variable::GreaterEq(const Variable& a, const Variable& b) {
@@ -138,16 +443,155 @@ Variable Variable::MultiOr(const std::vector<Variable>& vec) {
     return std::move(x);
 }
 
+//Sums and differences of narrower values need one bit more than the
+//operands, and are exact there, so the rest of the result is just the
+//extension.  C's promotions make this the common case: two uint8_t
+//promoted to int only need a 9 bit adder.
 Variable Variable::Add_(const Variable& a, const Variable& b) {
     assert(a.getTypeInfo() == b.getTypeInfo());
+    auto info = narrowest(a, b, 1);
+    if ((unsigned)info.size() < a.size()) {
+        return Add_(a.cast(info), b.cast(info)).cast(a.getTypeInfo());
+    }
     return do_addition(a, b, false);
 }
 
 Variable Variable::Sub_(const Variable& a, const Variable& b) {
     assert(a.getTypeInfo() == b.getTypeInfo());
+    //a difference can be negative even when the operands are not
+    auto info = narrowest(a, b, 1);
+    if ((unsigned)info.size() < a.size()) {
+        info = TypeInfo(true, info.size());
+        return Sub_(a.cast(info), b.cast(info)).cast(a.getTypeInfo());
+    }
     return do_addition(a, Not(b), true);
 }
 
+Variable Variable::Sum(const std::vector<Variable>& terms) {
+    assert(!terms.empty());
+    if (terms.size() == 1) {
+        return terms[0];
+    }
+    auto info = terms[0].getTypeInfo();
+    for (const auto& t : terms) {
+        info = converted(info, t.getTypeInfo());
+    }
+    std::vector<Variable> converted_terms;
+    converted_terms.reserve(terms.size());
+    for (const auto& t : terms) {
+        converted_terms.push_back((t.getTypeInfo() == info) ? t : t.cast(info));
+    }
+    return Sum_(converted_terms);
+}
+
+//Each column of bits of one weight is cut down with full adders (three
+//bits in, a sum bit out here and a carry into the next column) until
+//none holds more than two bits; then one carry-propagate adder adds the
+//two rows that are left.  The tree is logarithmic in depth, against a
+//chain of adders as deep as the number of terms.  Literal zeros never
+//enter a column, so sparse terms (shifted partial products) only cost
+//the bits they have.
+Variable Variable::Sum_(const std::vector<Variable>& terms) {
+    assert(check_multi_types(terms));
+    if (terms.size() <= 2) {
+        return (terms.size() == 1) ? terms[0] : Add_(terms[0], terms[1]);
+    }
+    //the sum of k terms needs ceil(log2(k)) bits more than the widest
+    unsigned extra = 0;
+    while ((1u << extra) < terms.size()) {
+        ++extra;
+    }
+    unsigned u = 0;
+    unsigned s = 0;
+    for (const auto& t : terms) {
+        u = std::max(u, t.unsignedWidth());
+        s = std::max(s, t.signedWidth());
+    }
+    auto type = terms[0].getTypeInfo();
+    auto info = narrowest(u, s, extra, type);
+    if (info.size() < type.size()) {
+        std::vector<Variable> narrow;
+        narrow.reserve(terms.size());
+        for (const auto& t : terms) {
+            narrow.push_back(t.cast(info));
+        }
+        return Sum_(narrow).cast(type);
+    }
+    unsigned n = type.size();
+    typedef SmallVector<Circuit::Value, 8> Column;
+    std::vector<Column> columns(n);
+    auto add = [](Column& column, Circuit::Value v) {
+        if (!v.isLiteral() || v.literalValue()) {
+            column.push_back(std::move(v));
+        }
+    };
+    //A sign extended term would put a copy of its sign bit in every
+    //column above it.  Since -s*2^(w-1) = (1-s)*2^(w-1) - 2^(w-1), it
+    //adds its inverted sign bit in column w-1 instead, and the 2^(w-1)
+    //of every term is taken off one constant.
+    bitvec constant(n);
+    for (const auto& t : terms) {
+        unsigned w = t.signedWidth();
+        if (w == n || t.unsignedWidth() <= w) {
+            w = std::min(t.unsignedWidth(), n);
+            for (unsigned i = 0; i < w; ++i) {
+                add(columns[i], t.bits[i]);
+            }
+            continue;
+        }
+        for (unsigned i = 0; i + 1 < w; ++i) {
+            add(columns[i], t.bits[i]);
+        }
+        add(columns[w-1], ::Not(t.bits[w-1]));
+        //constant -= 2^(w-1)
+        for (unsigned i = w - 1; i < n; ++i) {
+            constant[i] = !constant[i];
+            if (!constant[i]) {
+                break;
+            }
+        }
+    }
+    auto lit1 = Circuit::getLiteralTrue(terms[0].getCircuit());
+    for (unsigned i = 0; i < n; ++i) {
+        if (constant[i]) {
+            add(columns[i], lit1);
+        }
+    }
+    auto tallest = [&columns]() {
+        unsigned h = 0;
+        for (const auto& c : columns) {
+            h = std::max<unsigned>(h, c.size());
+        }
+        return h;
+    };
+    while (tallest() > 2) {
+        std::vector<Column> next(n);
+        for (unsigned i = 0; i < n; ++i) {
+            const auto& column = columns[i];
+            unsigned k = 0;
+            for (; k + 3 <= column.size(); k += 3) {
+                auto fa = FullAdder(column[k], column[k+1], column[k+2]);
+                add(next[i], std::move(fa.first));
+                if (i + 1 < n) {
+                    add(next[i+1], std::move(fa.second));
+                }
+            }
+            for (; k < column.size(); ++k) {
+                next[i].push_back(column[k]);
+            }
+        }
+        columns = std::move(next);
+    }
+    auto lit0 = Circuit::getLiteralFalse(terms[0].getCircuit());
+    Variable a(terms[0].getCircuit(), type);
+    Variable b(terms[0].getCircuit(), type);
+    for (unsigned i = 0; i < n; ++i) {
+        a.bits[i] = columns[i].size() > 0 ? columns[i][0] : lit0;
+        b.bits[i] = columns[i].size() > 1 ? columns[i][1] : lit0;
+    }
+    return Add_(a, b);
+}
+
 Variable Variable::mask_all(const Variable& a, const Variable& b) {
     const Variable& bit = b.isBit() ? b : b.asBit();
     Variable ret(a.getCircuit(), a.getTypeInfo());
@@ -158,12 +602,16 @@ Variable Variable::mask_all(const Variable& a, const Variable& b) {
 }
 
 Variable Variable::do_addition(const Variable& a, const Variable& b, bool c, Circuit::Value* carry_out) {
-    auto carry = c ? Circuit::getLiteralTrue(a.getCircuit()) 
-        : Circuit::getLiteralFalse(a.getCircuit());
+    return do_addition(a, b, c ? Circuit::getLiteralTrue(a.getCircuit()) 
+        : Circuit::getLiteralFalse(a.getCircuit()), carry_out);
+}
+
+Variable Variable::do_addition(const Variable& a, const Variable& b,
+        const Circuit::Value& carry_in, Circuit::Value* carry_out)
+{
     Variable ret(a.getCircuit(), a.getTypeInfo());
-    for (unsigned i = 0; i < a.size(); ++i) {
-        std::tie(ret.bits[i], carry) = FullAdder(a.bits[i], b.bits[i], std::move(carry));
-    }
+    auto carry = AddBits(Circuit::getAdder(a.getCircuit()), ret.bits,
+            a.bits, b.bits, carry_in);
     if (carry_out) {
         *carry_out = std::move(carry);
     }
@@ -172,13 +620,56 @@ Variable Variable::do_addition(const Variable& a, const Variable& b, bool c, Cir
 
 Variable Variable::Shl(const Variable& t, unsigned n) {
     //left shift
-    Variable ret(t.getCircuit(), t.getTypeInfo());
-    unsigned i = 0;
-    for (; i < std::min(n, t.size()); ++i) {
-        ret.bits[i] = Circuit::getLiteralFalse(t.getCircuit());
+    n = std::min(n, t.size());
+    auto zero = BitView::fill(Circuit::getLiteralFalse(t.getCircuit()), n);
+    return Variable(t.getCircuit(), concat(zero, t.view().slice(0, t.size() - n)), t.sign());
+}
+
+//A constant shift amount within [0, size), or -1.  Out of range amounts
+//are left to the general shifters, which define a result for them.
+static int constant_shift(const std::vector<bool>& k, unsigned size) {
+    unsigned amount = 0;
+    for (unsigned i = 0; i < k.size(); ++i) {
+        if (k[i] && (i >= 16 || (amount |= 1u << i) >= size)) {
+            return -1;
+        }
     }
-    for (; i < t.size(); ++i) {
-        ret.bits[i] = t.bits[i - n];
+    return amount;
+}
+
+//a < c, for a taken as unsigned
+static Circuit::Value below(const BitView& a, unsigned c) {
+    //bit by bit from the bottom: whether the low bits of a are below the
+    //low bits of c
+    auto lt = Circuit::getLiteralFalse(a[0].getCircuit());
+    for (unsigned k = 0; k < a.size(); ++k) {
+        bool ck = k < 32 && ((c >> k) & 1);
+        lt = ck ? ::Or(::Not(a[k]), lt) : ::And(::Not(a[k]), lt);
+    }
+    return lt;
+}
+
+Variable Variable::select(const Circuit::Value& c, const Variable& a, const Variable& b) {
+    assert(a.getTypeInfo() == b.getTypeInfo());
+    Variable ret(a.getCircuit(), a.getTypeInfo());
+    auto not_c = ::Not(c);
+    for (unsigned i = 0; i < a.size(); ++i) {
+        if (a.bits[i].source() == b.bits[i].source()) {
+            ret.bits[i] = a.bits[i];
+        }
+        else {
+            ret.bits[i] = ::Or(::And(c, a.bits[i]), ::And(not_c, b.bits[i]));
+        }
+    }
+    return std::move(ret);
+}
+
+Variable Variable::barrel(const Variable& t, const Variable& n,
+        Variable (&op)(const Variable&, unsigned))
+{
+    Variable ret{t};
+    for (unsigned k = 0; k < n.size() && (1u << k) < t.size(); ++k) {
+        ret = select(n.bits[k], op(ret, 1u << k), ret);
     }
     return std::move(ret);
 }
@@ -186,47 +677,155 @@ Variable Variable::Shl(const Variable& t, unsigned n) {
 Variable Variable::Shl_(const Variable& t, const Variable& n) {
     //left shift
     assert(t.getTypeInfo() == n.getTypeInfo());
-    std::vector<Variable> integers;
-    for (unsigned i = 0; i < t.size(); ++i) {
-        auto iseq = (n == i);
-        integers.push_back(mask_all(Shl(t, i), iseq));
+    if (n.isConstant()) {
+        auto k = constant_shift(n.constant_bits(), t.size());
+        if (k >= 0) {
+            return Shl(t, k);
+        }
     }
-    return MultiOr(integers);
+    Variable zero(0, t.getCircuit(), t.getTypeInfo());
+    return select(below(n.view(), t.size()), barrel(t, n, Shl), zero);
 }
 
 Variable Variable::Shr(const Variable& t, unsigned n) {
     //right shift
-    Variable ret(t.getCircuit(), t.getTypeInfo());
-    unsigned i = 0;
-    for (; i < std::min(n, t.size()); ++i) {
-        if (t.sign()) {
-            ret.bits[(t.size() - 1) - i] = t.bits[t.size() - 1];
+    n = std::min(n, t.size());
+    auto fill = BitView::fill(t.sign() ? t.bits[t.size() - 1]
+            : Circuit::getLiteralFalse(t.getCircuit()), n);
+    return Variable(t.getCircuit(), concat(t.view().slice(n, t.size()), fill), t.sign());
+}
+
+Variable Variable::Shr_(const Variable& t, const Variable& n) {
+    //right shift
+    assert(t.getTypeInfo() == n.getTypeInfo());
+    if (n.isConstant()) {
+        auto k = constant_shift(n.constant_bits(), t.size());
+        if (k >= 0) {
+            return Shr(t, k);
         }
-        else {
-            ret.bits[(t.size() - 1) - i] = Circuit::getLiteralFalse(t.getCircuit());
+    }
+    //out of range is Undefined Behavior; signed values give -1, as the
+    //most intuitive result
+    Variable out(t.sign() ? -1 : 0, t.getCircuit(), t.getTypeInfo());
+    return select(below(n.view(), t.size()), barrel(t, n, Shr), out);
+}
+
+Variable Variable::Rotl(const Variable& t, unsigned n) {
+    n %= t.size();
+    //the top n bits wrap around to the bottom
+    auto v = t.view();
+    return Variable(t.getCircuit(), concat(v.slice(t.size() - n, t.size()),
+                v.slice(0, t.size() - n)), t.sign());
+}
+
+Variable Variable::Rotr(const Variable& t, unsigned n) {
+    return Rotl(t, t.size() - n % t.size());
+}
+
+//an amount of any width, as unsigned, modulo n
+static unsigned constant_mod(const std::vector<bool>& k, unsigned n) {
+    unsigned long long r = 0;
+    for (unsigned i = k.size(); i-- > 0;) {
+        r = (2*r + k[i]) % n;
+    }
+    return r;
+}
+
+Variable Variable::Rotl(const Variable& t, const Variable& n) {
+    unsigned size = t.size();
+    if (n.isConstant()) {
+        return Rotl(t, constant_mod(n.constant_bits(), size));
+    }
+    //the barrel shifter only looks at the low bits, which are the amount
+    //modulo the width only if the width is a power of two
+    bool pow2 = (size & (size - 1)) == 0;
+    if (!pow2 && (n.size() >= 32 || (1u << n.size()) > size)) {
+        Variable u = n.cast(TypeInfo(false, n.size()));
+        return barrel(t, Rem(u, Variable(size, t.getCircuit(), u.getTypeInfo())), Rotl);
+    }
+    return barrel(t, n, Rotl);
+}
+
+Variable Variable::Rotr(const Variable& t, const Variable& n) {
+    unsigned size = t.size();
+    if (n.isConstant()) {
+        return Rotr(t, constant_mod(n.constant_bits(), size));
+    }
+    bool pow2 = (size & (size - 1)) == 0;
+    if (!pow2 && (n.size() >= 32 || (1u << n.size()) > size)) {
+        Variable u = n.cast(TypeInfo(false, n.size()));
+        return barrel(t, Rem(u, Variable(size, t.getCircuit(), u.getTypeInfo())), Rotr);
+    }
+    return barrel(t, n, Rotr);
+}
+
+Variable Variable::Bswap(const Variable& t) {
+    assert(t.size() % 8 == 0);
+    auto v = t.view();
+    BitView ret;
+    for (unsigned i = t.size(); i > 0; i -= 8) {
+        ret = concat(ret, v.slice(i - 8, i));
+    }
+    return Variable(t.getCircuit(), ret, t.sign());
+}
+
+Variable Variable::Popcount(const Variable& t) {
+    //adder tree: each level adds pairs of counts, one bit wider each time
+    auto lit0 = Circuit::getLiteralFalse(t.getCircuit());
+    auto adder = Circuit::getAdder(t.getCircuit());
+    std::vector<AdderBits> counts;
+    for (const auto& bit : t.bits) {
+        counts.push_back({bit});
+    }
+    while (counts.size() > 1) {
+        std::vector<AdderBits> next;
+        for (unsigned i = 0; i + 1 < counts.size(); i += 2) {
+            auto& x = counts[i];
+            auto& y = counts[i + 1];
+            //an odd count carried up from a lower level may be narrower
+            auto width = std::max(x.size(), y.size());
+            x.resize(width, lit0);
+            y.resize(width, lit0);
+            AdderBits sum;
+            auto carry = AddBits(adder, sum, x, y, lit0);
+            sum.push_back(carry);
+            next.push_back(std::move(sum));
+        }
+        if (counts.size() % 2) {
+            next.push_back(std::move(counts.back()));
         }
+        counts = std::move(next);
     }
-    for (; i < t.size(); ++i) {
-        ret.bits[(t.size() - 1) - i] = t.bits[(t.size() - 1) - (i - n)];
+    BitView count = counts[0];
+    count = count.slice(0, std::min(count.size(), t.size()));
+    return Variable(t.getCircuit(), concat(count,
+                BitView::fill(lit0, t.size() - count.size())), t.sign());
+}
+
+Variable Variable::Clz(const Variable& t) {
+    //bit i is set if bits i and above are all clear; these add up to the
+    //number of leading zeros
+    Variable zeros(t.getCircuit(), t.getTypeInfo());
+    auto any = t.bits[t.size() - 1];
+    for (unsigned i = t.size(); i-- > 0;) {
+        if (i < t.size() - 1) {
+            any = ::Or(any, t.bits[i]);
+        }
+        zeros.bits[i] = ::Not(any);
     }
-    return std::move(ret);
+    return Popcount(zeros);
 }
 
-Variable Variable::Shr_(const Variable& t, const Variable& n) {
-    //right shift
-    assert(t.getTypeInfo() == n.getTypeInfo());
-    std::vector<Variable> integers;
-    std::vector<Circuit::Value> bits;
+Variable Variable::Ctz(const Variable& t) {
+    Variable zeros(t.getCircuit(), t.getTypeInfo());
+    auto any = t.bits[0];
     for (unsigned i = 0; i < t.size(); ++i) {
-        auto iseq = (n == i);
-        integers.push_back(mask_all(Shr(t, i), iseq));
-        bits.push_back(iseq.bits[0]);
-    }
-    if (t.sign()) {
-        //this is Undefined Behavior, but is the most intuitive result
-        integers.push_back(mask_all(Variable(-1, t.getCircuit(), t.getTypeInfo()), !Variable(::MultiOr(bits))));
+        if (i > 0) {
+            any = ::Or(any, t.bits[i]);
+        }
+        zeros.bits[i] = ::Not(any);
     }
-    return MultiOr(integers);
+    return Popcount(zeros);
 }
 
 Variable Variable::Ternary_(const Variable& t, const Variable& f, const Variable& cond) {
@@ -239,89 +838,380 @@ void Variable::DivRem_(const Variable& val, const Variable& div,
         Variable* quot, Variable* rem)
 {
     assert(val.getTypeInfo() == div.getTypeInfo());
-    //abs is noop for unsigned
-    divrem_unsigned(val.abs(), div.abs(), quot, rem);
-    if (val.sign()) {
-        if (rem) {
-            rem->overwrite(Ternary(val.isNeg(), Negative(*rem), *rem));
-        }
-        if (quot) {
-            quot->overwrite(Ternary(val.isNeg() ^ div.isNeg(), Negative(*quot), *quot));
+    if (div.isConstant()) {
+        auto d = div.constant_bits();
+        //leave division by zero to the general case
+        if (std::find(begin(d), end(d), true) != end(d)) {
+            divrem_constant(val, d, quot, rem);
+            return;
         }
     }
+    if (!val.sign()) {
+        divrem_unsigned(val, div, quot, rem);
+        return;
+    }
+    //divide the magnitudes, then fix up the signs.  C rounds towards zero,
+    //so the remainder takes the sign of the dividend.
+    const auto& val_neg = val.bits[val.size()-1];
+    const auto& div_neg = div.bits[div.size()-1];
+    Variable q(val.getCircuit(), val.getTypeInfo());
+    Variable r(val.getCircuit(), val.getTypeInfo());
+    divrem_unsigned(negate_if(val, val_neg), negate_if(div, div_neg),
+            quot ? &q : nullptr, rem ? &r : nullptr);
+    if (rem) {
+        rem->overwrite(negate_if(r, val_neg));
+    }
+    if (quot) {
+        quot->overwrite(negate_if(q, ::Xor(val_neg, div_neg)));
+    }
+}
+
+Variable Variable::negate_if(const Variable& a, const Circuit::Value& cond) {
+    //-a == ~a + 1, so xor with the condition and add it back in.  Adding to
+    //zero folds the adder down to an incrementer.
+    Variable zero(0, a.getCircuit(), a.getTypeInfo());
+    return do_addition(Xor_(a, generateMask(Variable(cond), a.getTypeInfo())),
+            zero, cond);
 }
 
 void Variable::divrem_unsigned(const Variable& val, const Variable& div,
         Variable* quot, Variable* rem)
 {
+    //operands are treated as unsigned regardless of their type
+    if (Circuit::getDivider(val.getCircuit()) == Circuit::Divider::NON_RESTORING) {
+        divrem_nonrestoring(val, div, quot, rem);
+    }
+    else {
+        divrem_restoring(val, div, quot, rem);
+    }
+}
+
+void Variable::divrem_restoring(const Variable& val, const Variable& div,
+        Variable* quot, Variable* rem)
+{
+    unsigned n = val.size();
     Variable q(val.getCircuit(), val.getTypeInfo());
-    Variable r(0, val.getCircuit(), val.getTypeInfo());
-    //handle division by zero in a somewhat sane manner
-    Variable mask = val.generateMask(div == 0);
-    for (unsigned i = 0; i < val.size(); ++i) {
-        r <<= 1;
-        r.bits[0] = val.bits[val.size() - 1 - i];
-        auto should_sub = r >= div;
-        q.bits[val.size() - 1 - i] = should_sub.bits[0];
-        r = Ternary(should_sub, r - div, r);
+    //Before step i the partial remainder is below both div and 2^i, so
+    //after shifting in the next dividend bit it fits in i+1 bits.  It can
+    //only be >= div if the divisor's higher bits are all zero, so each
+    //step only needs an (i+1)-bit subtractor, whose carry out doubles as
+    //the comparison.  Division by zero gives all ones and the dividend.
+    std::vector<Circuit::Value> high_zero(n);
+    high_zero[n-1] = Circuit::getLiteralTrue(val.getCircuit());
+    for (unsigned i = n - 1; i > 0; --i) {
+        high_zero[i-1] = ::And(high_zero[i], ::Not(div.bits[i]));
+    }
+    std::vector<Circuit::Value> r;
+    for (unsigned i = 0; i < n; ++i) {
+        r.insert(r.begin(), val.bits[n-1-i]);
+        Variable partial(val.getCircuit(), TypeInfo(false, i + 1));
+        Variable divisor(val.getCircuit(), TypeInfo(false, i + 1));
+        for (unsigned j = 0; j <= i; ++j) {
+            partial.bits[j] = r[j];
+            divisor.bits[j] = div.bits[j];
+        }
+        Circuit::Value no_borrow;
+        auto diff = do_addition(partial, Not(divisor), true, &no_borrow);
+        auto should_sub = ::And(no_borrow, high_zero[i]);
+        q.bits[n-1-i] = should_sub;
+        auto not_sub = ::Not(should_sub);
+        for (unsigned j = 0; j <= i; ++j) {
+            r[j] = ::Or(::And(should_sub, diff.bits[j]), ::And(not_sub, r[j]));
+        }
     }
     if (quot) {
         quot->overwrite(std::move(q));
     }
     if (rem) {
-        rem->overwrite(std::move(r));
+        Variable x(val.getCircuit(), val.getTypeInfo());
+        std::copy(begin(r), end(r), begin(x.bits));
+        rem->overwrite(std::move(x));
     }
 }
 
+void Variable::divrem_nonrestoring(const Variable& val, const Variable& div,
+        Variable* quot, Variable* rem)
+{
+    unsigned n = val.size();
+    Variable q(val.getCircuit(), val.getTypeInfo());
+    //The partial remainder is kept in n+1 bit two's complement and is
+    //always in [-div, div).  Instead of restoring a negative remainder,
+    //the next step adds the divisor back rather than subtracting it, so
+    //each step is a single adder with no multiplexer.
+    TypeInfo info(true, n + 1);
+    //the magnitude of INT_MIN is only representable unsigned
+    auto divisor = div.cast(TypeInfo(false, n)).cast(TypeInfo(false, n + 1));
+    Variable r(0, val.getCircuit(), info);
+    for (unsigned i = 0; i < n; ++i) {
+        auto negative = r.bits[n];
+        r = Shl(r, 1);
+        r.bits[0] = val.bits[n-1-i];
+        //subtract if non-negative: r + ~div + 1, otherwise r + div
+        Variable operand(val.getCircuit(), info);
+        for (unsigned j = 0; j <= n; ++j) {
+            operand.bits[j] = ::Xnor(divisor.bits[j], negative);
+        }
+        r = do_addition(r, operand, ::Not(negative));
+        q.bits[n-1-i] = ::Not(r.bits[n]);
+    }
+    if (quot) {
+        quot->overwrite(std::move(q));
+    }
+    if (rem) {
+        //a negative final remainder still needs the divisor added back
+        r = do_addition(r, mask_all(divisor, Variable(r.bits[n])), false);
+        rem->overwrite(r.cast(TypeInfo(false, n)).cast(val.getTypeInfo()));
+    }
+}
+
+Variable Variable::Mul_(const Variable& a, const Variable& b) {
+    assert(a.getTypeInfo() == b.getTypeInfo());
+    //the full product of narrower values is exact in twice their width
+    auto info = narrowest(a, b, 0);
+    if ((unsigned)info.size()*2 <= a.size()) {
+        return Mul_full_(a.cast(info), b.cast(info)).cast(a.getTypeInfo());
+    }
+    if (b.isConstant()) {
+        return mul_constant(a, b.constant_bits());
+    }
+    if (a.isConstant()) {
+        return mul_constant(b, a.constant_bits());
+    }
+    return mul_array(a, b, a.size());
+}
+
 Variable Variable::Mul_full_(const Variable& a, const Variable& b) {
     assert(a.getTypeInfo() == b.getTypeInfo());
-    auto ret = mul_unsigned(a.abs(), b.abs());
-    if (a.sign()) {
-        ret = Variable::Ternary(a.isNeg() ^ b.isNeg(), Variable::Negative(ret), ret);
+    auto info = narrowest(a, b, 0);
+    if ((unsigned)info.size() < a.size()) {
+        return Mul_full_(a.cast(info), b.cast(info)).cast(TypeInfo(a.sign(), a.size()*2));
     }
-    return std::move(ret);
+    if (a.isConstant() || b.isConstant()) {
+        //the product of the extended operands is exact in twice the width
+        const auto& c = a.isConstant() ? a : b;
+        const auto& x = a.isConstant() ? b : a;
+        TypeInfo info(a.sign(), a.size()*2);
+        return mul_constant(x.cast(info), c.cast(info).constant_bits());
+    }
+    return mul_array(a, b, a.size()*2);
 }
 
-Variable Variable::mul_unsigned(const Variable& a, const Variable& b) {
+//Sums one row of AND partial products per bit of b, keeping only the
+//columns below width: a truncated product never builds the upper half
+//of the array.  Full signed products use the Baugh-Wooley form: partial
+//products pairing one sign bit with a magnitude bit carry negative
+//weight, so they are complemented instead, and adding 2^n and 2^(2n-1)
+//makes up the difference.  The product comes out in two's complement
+//with no negation before or after.  The low n bits are the same for
+//either signedness, so a truncated product needs no correction.
+Variable Variable::mul_array(const Variable& a, const Variable& b, unsigned width) {
     assert(a.getTypeInfo() == b.getTypeInfo());
-    auto result_size = a.size()*2;
-    auto x = a.cast(TypeInfo(a.sign(), result_size));
-    Variable ret(0, a.getCircuit(), x.getTypeInfo());
-    for (unsigned i = 0; i < a.size(); ++i) {
-        ret = Variable::Ternary(b.bits[i], ret + x, ret);
-        x <<= 1;
+    unsigned n = a.size();
+    assert(width == n || width == n*2);
+    bool baugh_wooley = a.sign() && n > 1 && width == n*2;
+    TypeInfo info(false, width);
+    auto lit0 = Circuit::getLiteralFalse(a.getCircuit());
+    auto lit1 = Circuit::getLiteralTrue(a.getCircuit());
+    std::vector<Variable> rows;
+    rows.reserve(n);
+    for (unsigned i = 0; i < n; ++i) {
+        Variable row(a.getCircuit(), BitView::fill(lit0, width), false);
+        for (unsigned j = 0; j < n && i + j < width; ++j) {
+            bool negative = baugh_wooley && ((i == n - 1) != (j == n - 1));
+            row.bits[i + j] = negative ? ::Nand(a.bits[j], b.bits[i]) : ::And(a.bits[j], b.bits[i]);
+        }
+        if (baugh_wooley && i == 0) {
+            row.bits[n] = lit1;
+        }
+        if (baugh_wooley && i == n - 1) {
+            row.bits[n*2 - 1] = lit1;
+        }
+        rows.push_back(std::move(row));
     }
+    auto ret = Sum_(rows);
+    ret.is_signed = a.sign();
     return std::move(ret);
 }
 
-Variable Variable::cast(TypeInfo info) const {
-    Variable ret{this->getCircuit(), info};
-    if (info.isBit()) {
-        //cast to bit
-        ret.bits[0] = ::Not(isZero().bits[0]);
+//Helpers for arithmetic on the bit patterns of constants, so that
+//divisors of any width can be handled without going through FlexInt
+
+static bitvec bv_negate(bitvec v) {
+    bool carry = true;
+    for (unsigned i = 0; i < v.size(); ++i) {
+        bool b = !v[i];
+        v[i] = (b != carry);
+        carry = b && carry;
     }
-    else if (ret.size() < size()) {
-        for (unsigned i = 0; i < ret.size(); ++i) {
-            ret.bits[i] = bits[i];
-        }
+    return v;
+}
+
+//index of the most significant set bit, or -1 if zero
+static int bv_msb(const bitvec& v) {
+    for (int i = v.size() - 1; i >= 0; --i) {
+        if (v[i]) return i;
     }
-    else {
-        unsigned i;
-        for (i = 0; i < size(); ++i) {
-            ret.bits[i] = bits[i];
+    return -1;
+}
+
+//k if v == 2^k, otherwise -1
+static int bv_log2(const bitvec& v) {
+    auto msb = bv_msb(v);
+    for (int i = 0; i < msb; ++i) {
+        if (v[i]) return -1;
+    }
+    return msb;
+}
+
+//floor(2^shift / d) + 1, truncated to width bits
+static bitvec bv_reciprocal(unsigned shift, const bitvec& d, unsigned width) {
+    bitvec q(width);
+    bitvec r(d.size() + 1);
+    //restoring division of 2^shift by d, one dividend bit at a time
+    for (int i = shift; i >= 0; --i) {
+        r.insert(r.begin(), (unsigned)i == shift);
+        r.pop_back();
+        bool geq = true;
+        for (int j = r.size() - 1; j >= 0; --j) {
+            bool dj = ((unsigned)j < d.size()) && d[j];
+            if (r[j] != dj) {
+                geq = r[j];
+                break;
+            }
         }
-        for (; i < ret.size(); ++i) {
-            if (ret.sign()) {
-                ret.bits[i] = bits[size()-1];
+        if (geq) {
+            bool borrow = false;
+            for (unsigned j = 0; j < r.size(); ++j) {
+                bool dj = (j < d.size()) && d[j];
+                bool diff = (r[j] != dj) != borrow;
+                borrow = (!r[j] && (dj || borrow)) || (r[j] && dj && borrow);
+                r[j] = diff;
             }
-            else {
-                ret.bits[i] = Circuit::getLiteralFalse(this->getCircuit());
+            if ((unsigned)i < width) {
+                q[i] = true;
             }
         }
     }
+    //and increment
+    for (unsigned i = 0; i < width; ++i) {
+        q[i] = !q[i];
+        if (q[i]) break;
+    }
+    return q;
+}
+
+Variable Variable::mul_constant(const Variable& x, const std::vector<bool>& c) {
+    assert(x.size() == c.size());
+    //Recode the constant into canonical signed digits, so that a run of
+    //ones costs one addition and one subtraction instead of one addition
+    //per bit.  The result is only needed modulo 2^size.
+    std::vector<unsigned> add, sub;
+    bool carry = false;
+    for (unsigned i = 0; i < c.size(); ++i) {
+        unsigned digit = c[i] + carry;
+        bool next = (i + 1 < c.size()) && c[i+1];
+        if (digit == 1) {
+            (next ? sub : add).push_back(i);
+            carry = next;
+        }
+        else {
+            carry = (digit == 2);
+        }
+    }
+    //shifted copies of x only rewire bits, so the literal zero bits they
+    //introduce fold away inside the adders
+    Variable ret(0, x.getCircuit(), x.getTypeInfo());
+    for (auto i : add) {
+        ret = Add_(ret, Shl(x, i));
+    }
+    for (auto i : sub) {
+        ret = Sub_(ret, Shl(x, i));
+    }
     return std::move(ret);
 }
 
+void Variable::divrem_constant(const Variable& val, const std::vector<bool>& d,
+        Variable* quot, Variable* rem)
+{
+    assert(val.size() == d.size());
+    unsigned n = val.size();
+    bool negative = val.sign() && d[n-1];
+    auto magnitude = negative ? bv_negate(d) : d;
+    Variable q(val.getCircuit(), val.getTypeInfo());
+    int k = bv_log2(magnitude);
+    if (k >= 0) {
+        if (val.sign()) {
+            //bias negative dividends by 2^k - 1 to round towards zero
+            Variable bias(0, val.getCircuit(), val.getTypeInfo());
+            for (int i = 0; i < k; ++i) {
+                bias.bits[i] = val.bits[n-1];
+            }
+            q = Shr(Add_(val, bias), k);
+        }
+        else if (!rem) {
+            q = Shr(val, k);
+        }
+        else {
+            //unsigned remainder is just the low bits
+            if (quot) {
+                quot->overwrite(Shr(val, k));
+            }
+            Variable r(0, val.getCircuit(), val.getTypeInfo());
+            for (int i = 0; i < k; ++i) {
+                r.bits[i] = val.bits[i];
+            }
+            rem->overwrite(std::move(r));
+            return;
+        }
+    }
+    else {
+        //multiply by a rounded-up reciprocal and keep the high part.  See
+        //Granlund & Montgomery, "Division by Invariant Integers using
+        //Multiplication" (theorems 4.2 and 5.1).
+        unsigned shift = (val.sign() ? n - 1 : n) + bv_msb(magnitude) + 1;
+        TypeInfo wide(val.sign(), 2*n + 1);
+        auto m = bv_reciprocal(shift, magnitude, wide.size());
+        q = Shr(mul_constant(val.cast(wide), m), shift).cast(val.getTypeInfo());
+        if (val.sign()) {
+            //floor() rounds negative quotients down, so add one back
+            Variable zero(0, val.getCircuit(), val.getTypeInfo());
+            q = do_addition(q, zero, val.bits[n-1]);
+        }
+    }
+    if (rem) {
+        //val - q*|d| is also the remainder for -|d|
+        rem->overwrite(Sub_(val, mul_constant(q, magnitude)));
+    }
+    if (quot) {
+        quot->overwrite(negative ? Negative(q) : std::move(q));
+    }
+}
+
+Variable Variable::cast(TypeInfo info) const {
+    if (info.isBit()) {
+        //cast to bit
+        auto ret = asBit();
+        ret.is_signed = info.sign();
+        return ret;
+    }
+    if ((unsigned)info.size() <= size()) {
+        return Variable(getCircuit(), view().slice(0, info.size()), info.sign());
+    }
+    //extension follows the source, as in C: (unsigned)(int8_t)-1 is
+    //0xffffffff, while (int)(uint8_t)255 is 255
+    auto fill = BitView::fill(sign() ? bits[size()-1]
+            : Circuit::getLiteralFalse(getCircuit()), info.size() - size());
+    return Variable(getCircuit(), concat(view(), fill), info.sign());
+}
+
+Variable Variable::extract(unsigned lo, unsigned hi) const {
+    return Variable(getCircuit(), view().slice(lo, hi), false);
+}
+
+Variable Variable::Concat(const Variable& lo, const Variable& hi) {
+    return Variable(lo.getCircuit(), concat(lo.view(), hi.view()), false);
+}
+
 #define DEFINE_BINARY_OP(op, name) \
     Variable operator op(const Variable& a, const Variable& b) { \
         return Variable::name(a, b); \
@@ -369,6 +1259,7 @@ decltype(Variable::Shr_proxy) Variable::Shr_proxy;
 //Comparisons
 decltype(Variable::Less_proxy) Variable::Less_proxy;
 decltype(Variable::Equal_proxy) Variable::Equal_proxy;
+decltype(Variable::Compare) Variable::Compare;
 //Ternary
 decltype(Variable::do_ternary) Variable::do_ternary;
 
@@ -0,0 +1,330 @@
+#include <CXXSat/WideInt.h>
+
+#include <algorithm>
+#include <string>
+#include <assert.h>
+
+void WideInt::normalize() {
+    limbs.resize(words());
+    if (size() % 32) {
+        limbs.back() &= ~(uint32_t)0 >> (32 - size() % 32);
+    }
+}
+
+uint32_t WideInt::word(unsigned k) const {
+    uint32_t fill = negative() ? ~(uint32_t)0 : 0;
+    if (k >= limbs.size()) {
+        return fill;
+    }
+    unsigned top = size() - 32*k;
+    if (top < 32) {
+        return limbs[k] | (fill << top);
+    }
+    return limbs[k];
+}
+
+WideInt::WideInt(const WideInt& w, TypeInfo info) : WideInt(info) {
+    for (unsigned k = 0; k < limbs.size(); ++k) {
+        limbs[k] = w.word(k);
+    }
+    normalize();
+}
+
+WideInt::operator bool() const {
+    return std::any_of(limbs.begin(), limbs.end(), [](uint32_t x) { return x != 0; });
+}
+
+WideInt WideInt::operator~() const {
+    WideInt ret{*this};
+    for (auto& x : ret.limbs) {
+        x = ~x;
+    }
+    ret.normalize();
+    return ret;
+}
+
+WideInt WideInt::operator-() const {
+    return WideInt{type} - *this;
+}
+
+WideInt& WideInt::operator++() {
+    return *this = *this + WideInt(1, type);
+}
+
+WideInt& WideInt::operator--() {
+    return *this = *this - WideInt(1, type);
+}
+
+WideInt operator+(const WideInt& a, const WideInt& b) {
+    WideInt ret{a.type};
+    uint64_t carry = 0;
+    for (unsigned k = 0; k < ret.limbs.size(); ++k) {
+        carry += (uint64_t)a.word(k) + b.word(k);
+        ret.limbs[k] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    ret.normalize();
+    return ret;
+}
+
+WideInt operator-(const WideInt& a, const WideInt& b) {
+    //a + ~b + 1
+    WideInt ret{a.type};
+    uint64_t carry = 1;
+    for (unsigned k = 0; k < ret.limbs.size(); ++k) {
+        carry += (uint64_t)a.word(k) + (uint32_t)~b.word(k);
+        ret.limbs[k] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    ret.normalize();
+    return ret;
+}
+
+WideInt operator*(const WideInt& a, const WideInt& b) {
+    //only the low size() bits are kept, which are the same signed or not
+    WideInt ret{a.type};
+    unsigned n = ret.limbs.size();
+    for (unsigned i = 0; i < n; ++i) {
+        uint64_t carry = 0;
+        for (unsigned j = 0; i + j < n; ++j) {
+            carry += (uint64_t)a.word(i) * b.word(j) + ret.limbs[i + j];
+            ret.limbs[i + j] = (uint32_t)carry;
+            carry >>= 32;
+        }
+    }
+    ret.normalize();
+    return ret;
+}
+
+void WideInt::divmod(const WideInt& a, const WideInt& b, WideInt* quot, WideInt* rem) {
+    assert(b);
+    //shift-subtract on the magnitudes, which always fit unsigned.  C
+    //rounds towards zero, so the remainder takes the dividend's sign.
+    unsigned n = a.size();
+    TypeInfo mag_t(false, n);
+    WideInt x(a.negative() ? -a : a, mag_t);
+    WideInt y(b.negative() ? -b : b, mag_t);
+    WideInt q{mag_t};
+    WideInt r{TypeInfo(false, n + 1)};
+    WideInt d(y, r.type);
+    for (unsigned i = n; i-- > 0;) {
+        r = r + r;
+        if (x.testbit(i)) {
+            r.limbs[0] |= 1;
+        }
+        if (r >= d) {
+            r = r - d;
+            q.limbs[i/32] |= (uint32_t)1 << (i % 32);
+        }
+    }
+    if (quot) {
+        *quot = WideInt(q, a.type);
+        if (a.negative() != b.negative()) {
+            *quot = -*quot;
+        }
+    }
+    if (rem) {
+        *rem = WideInt(r, a.type);
+        if (a.negative()) {
+            *rem = -*rem;
+        }
+    }
+}
+
+WideInt operator/(const WideInt& a, const WideInt& b) {
+    WideInt q;
+    WideInt::divmod(a, b, &q, nullptr);
+    return q;
+}
+
+WideInt operator%(const WideInt& a, const WideInt& b) {
+    WideInt r;
+    WideInt::divmod(a, b, nullptr, &r);
+    return r;
+}
+
+//shift amounts past the width saturate
+static unsigned shift_amount(const WideInt& b) {
+    if (b.negative() || b >= WideInt(b.size(), b.getTypeInfo())) {
+        return b.size();
+    }
+    return (unsigned)b;
+}
+
+WideInt operator<<(const WideInt& a, const WideInt& b) {
+    unsigned s = std::min(shift_amount(b), a.size());
+    WideInt ret{a.type};
+    for (unsigned i = s; i < a.size(); ++i) {
+        if (a.testbit(i - s)) {
+            ret.limbs[i/32] |= (uint32_t)1 << (i % 32);
+        }
+    }
+    return ret;
+}
+
+WideInt operator>>(const WideInt& a, const WideInt& b) {
+    //arithmetic for signed types, like the native ones
+    unsigned s = std::min(shift_amount(b), a.size());
+    WideInt ret{a.type};
+    for (unsigned i = 0; i < a.size(); ++i) {
+        if (i + s < a.size() ? a.testbit(i + s) : a.negative()) {
+            ret.limbs[i/32] |= (uint32_t)1 << (i % 32);
+        }
+    }
+    return ret;
+}
+
+WideInt operator&(const WideInt& a, const WideInt& b) {
+    WideInt ret{a.type};
+    for (unsigned k = 0; k < ret.limbs.size(); ++k) {
+        ret.limbs[k] = a.word(k) & b.word(k);
+    }
+    ret.normalize();
+    return ret;
+}
+
+WideInt operator|(const WideInt& a, const WideInt& b) {
+    WideInt ret{a.type};
+    for (unsigned k = 0; k < ret.limbs.size(); ++k) {
+        ret.limbs[k] = a.word(k) | b.word(k);
+    }
+    ret.normalize();
+    return ret;
+}
+
+WideInt operator^(const WideInt& a, const WideInt& b) {
+    WideInt ret{a.type};
+    for (unsigned k = 0; k < ret.limbs.size(); ++k) {
+        ret.limbs[k] = a.word(k) ^ b.word(k);
+    }
+    ret.normalize();
+    return ret;
+}
+
+bool operator<(const WideInt& a, const WideInt& b) {
+    if (a.negative() != b.negative()) {
+        return a.negative();
+    }
+    //same sign: two's complement words order the same way unsigned
+    unsigned n = std::max(a.words(), b.words());
+    for (unsigned k = n; k-- > 0;) {
+        if (a.word(k) != b.word(k)) {
+            return a.word(k) < b.word(k);
+        }
+    }
+    return false;
+}
+
+bool operator>(const WideInt& a, const WideInt& b) {
+    return b < a;
+}
+
+bool operator<=(const WideInt& a, const WideInt& b) {
+    return !(b < a);
+}
+
+bool operator>=(const WideInt& a, const WideInt& b) {
+    return !(a < b);
+}
+
+bool operator==(const WideInt& a, const WideInt& b) {
+    unsigned n = std::max(a.words(), b.words());
+    for (unsigned k = 0; k < n; ++k) {
+        if (a.word(k) != b.word(k)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool operator!=(const WideInt& a, const WideInt& b) {
+    return !(a == b);
+}
+
+uint32_t WideInt::divmod_small(uint32_t d) {
+    uint64_t r = 0;
+    for (unsigned k = limbs.size(); k-- > 0;) {
+        r = (r << 32) | limbs[k];
+        limbs[k] = (uint32_t)(r / d);
+        r %= d;
+    }
+    return (uint32_t)r;
+}
+
+static unsigned stream_base(const std::ios_base& s) {
+    switch (s.flags() & std::ios_base::basefield) {
+    case std::ios_base::hex:
+        return 16;
+    case std::ios_base::oct:
+        return 8;
+    default:
+        return 10;
+    }
+}
+
+std::ostream& operator<<(std::ostream& os, const WideInt& w) {
+    unsigned base = stream_base(os);
+    //like the native types, only decimal output shows a sign
+    bool minus = base == 10 && w.negative();
+    WideInt x(minus ? -w : w, TypeInfo(false, w.size()));
+    std::string digits;
+    do {
+        digits += "0123456789abcdef"[x.divmod_small(base)];
+    } while (x);
+    if (minus) {
+        digits += '-';
+    }
+    std::reverse(digits.begin(), digits.end());
+    return os << digits;
+}
+
+std::istream& operator>>(std::istream& is, WideInt& w) {
+    std::istream::sentry sentry(is);
+    if (!sentry) {
+        return is;
+    }
+    unsigned base = stream_base(is);
+    bool minus = false;
+    if (is.peek() == '-' || is.peek() == '+') {
+        minus = is.get() == '-';
+    }
+    //accumulate the magnitude with headroom to notice overflow
+    unsigned n = w.size();
+    TypeInfo mag_t(false, n + 8);
+    WideInt x{mag_t};
+    bool any = false;
+    bool overflow = false;
+    for (auto c = is.peek(); c != std::istream::traits_type::eof(); c = is.peek()) {
+        unsigned digit;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        }
+        else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        }
+        else if (c >= 'A' && c <= 'F') {
+            digit = c - 'A' + 10;
+        }
+        else {
+            break;
+        }
+        if (digit >= base) {
+            break;
+        }
+        is.get();
+        x = x * WideInt(base, mag_t) + WideInt(digit, mag_t);
+        overflow = overflow || (bool)(x >> WideInt(n, mag_t));
+        any = true;
+    }
+    if (w.sign() && x.testbit(n - 1)) {
+        //only the most negative value may use the top bit
+        overflow = overflow || !minus || x != (WideInt(1, mag_t) << WideInt(n - 1, mag_t));
+    }
+    if (!any || overflow) {
+        is.setstate(std::ios_base::failbit);
+        return is;
+    }
+    x = WideInt(x, w.type);
+    w = minus ? -x : x;
+    return is;
+}
@@ -0,0 +1,105 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <functional>
+#include <stdlib.h>
+#include <CXXSat/Circuit.h>
+#include <CXXSat/Argument.h>
+#include <CXXSat/Variable.h>
+#include <CXXSat/Sat.h>
+
+//Prints the CNF size and solve time of a few adder-heavy problems under
+//each adder architecture, so the choice can be made on measurements.
+
+typedef std::function<Variable(Circuit&, unsigned)> Workload;
+
+static void run(const char* name, Circuit::Adder adder, unsigned bits,
+        const Workload& w)
+{
+    auto c = Circuit();
+    c.setAdder(adder);
+    auto start = std::chrono::steady_clock::now();
+    auto p = c.generateCNF(w(c, bits));
+    auto generated = std::chrono::steady_clock::now();
+    auto soln = p.solve();
+    auto solved = std::chrono::steady_clock::now();
+    auto ms = [](auto d) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+    };
+    std::cout << std::setw(10) << name
+        << std::setw(6) << bits
+        << std::setw(10) << p.numVars()
+        << std::setw(10) << p.numClauses()
+        << std::setw(10) << ms(generated - start)
+        << std::setw(10) << ms(solved - generated)
+        << (soln ? "  SAT" : "  UNSAT") << '\n';
+}
+
+int main(int argc, char** argv) {
+    CastMode::set(CastMode::MANUAL);
+    if (argc > 2) {
+        std::cerr << "USAGE: " + std::string(argv[0]) + " [maxbits]\n";
+        return 1;
+    }
+    unsigned maxbits = (argc == 2) ? atoi(argv[1]) : 32;
+    const std::pair<const char*, Circuit::Adder> adders[] = {
+        {"ripple", Circuit::Adder::RIPPLE},
+        {"lookahead", Circuit::Adder::CARRY_LOOKAHEAD},
+        {"kogge", Circuit::Adder::KOGGE_STONE},
+        {"brent", Circuit::Adder::BRENT_KUNG},
+        {"select", Circuit::Adder::CARRY_SELECT}
+    };
+    const std::pair<const char*, Workload> workloads[] = {
+        //x + y == s && x - y == d: a unique solution through two adders
+        {"add/sub", [](Circuit& c, unsigned n) {
+            auto x = c.addArgument(TypeInfo{false, (int)n}).asValue();
+            auto y = c.addArgument(TypeInfo{false, (int)n}).asValue();
+            auto s = Variable::getLiteral(FlexInt(0x5a5a5a5a5a5a5a5aULL)
+                    .cast(TypeInfo{false, (int)n}), c.getPimpl());
+            auto d = Variable::getLiteral(FlexInt(0x1234567812345678ULL)
+                    .cast(TypeInfo{false, (int)n}), c.getPimpl());
+            return Variable::LogAnd(x + y == s, x - y == d);
+        }},
+        //x < y < z < x + 3, with no overflow: a chain of comparators
+        {"compare", [](Circuit& c, unsigned n) {
+            auto x = c.addArgument(TypeInfo{false, (int)n}).asValue();
+            auto y = c.addArgument(TypeInfo{false, (int)n}).asValue();
+            auto z = c.addArgument(TypeInfo{false, (int)n}).asValue();
+            auto three = Variable::getLiteral(FlexInt(3U)
+                    .cast(TypeInfo{false, (int)n}), c.getPimpl());
+            return Variable::MultiAnd({x < y, y < z, z < x + three, x < x + three});
+        }},
+        //factor the product of two n/2 bit primes
+        {"multiply", [](Circuit& c, unsigned n) {
+            const unsigned long long primes[] = {
+                13, 251, 65521, 4294967291ULL
+            };
+            unsigned long long p = primes[0];
+            for (auto q : primes) {
+                if (q < (1ULL << (n/2))) {
+                    p = q;
+                }
+            }
+            auto x = c.addArgument(TypeInfo{false, (int)n/2}).asValue();
+            auto y = c.addArgument(TypeInfo{false, (int)n/2}).asValue();
+            auto z = Variable::getLiteral(FlexInt((unsigned long long)p * p)
+                    .cast(TypeInfo{false, (int)n}), c.getPimpl());
+            auto one = Variable::getLiteral(FlexInt(1U)
+                    .cast(TypeInfo{false, (int)n/2}), c.getPimpl());
+            return Variable::MultiAnd({z == Variable::Mul_full(x, y), x != one, y != one});
+        }}
+    };
+    std::cout << std::setw(10) << "adder" << std::setw(6) << "bits"
+        << std::setw(10) << "vars" << std::setw(10) << "clauses"
+        << std::setw(10) << "gen ms" << std::setw(10) << "solve ms" << '\n';
+    for (auto& w : workloads) {
+        std::cout << w.first << '\n';
+        for (unsigned bits = 8; bits <= maxbits; bits *= 2) {
+            for (auto& a : adders) {
+                run(a.first, a.second, bits, w.second);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include <iostream>
+#include <vector>
+#include <stdint.h>
+#include <CXXSat/Circuit.h>
+#include <CXXSat/Argument.h>
+#include <CXXSat/Variable.h>
+#include <CXXSat/Sat.h>
+#include <CXXSat/SolverSession.h>
+#include "Check.h"
+
+//for a constant v: whether it holds value
+static bool equals(const Variable& v, uint64_t value) {
+    Variable eq = v == Variable(value, v.getCircuit(), v.getTypeInfo());
+    return eq.isConstant() && eq.unsignedWidth() == 1;
+}
+
+//assumes the bits of v are those of value
+static void assume(SolverSession& s, std::vector<int>& lits, const Variable& v, uint64_t value) {
+    auto bits = v.view();
+    for (unsigned i = 0; i < bits.size(); ++i) {
+        int lit = s.literal(Variable(bits[i]));
+        lits.push_back(((value >> i) & 1) ? lit : -lit);
+    }
+}
+
+static uint64_t rotl(uint64_t a, unsigned n, unsigned width) {
+    uint64_t mask = (1ull << width) - 1;
+    a &= mask;
+    n %= width;
+    return n ? ((a << n) | (a >> (width - n))) & mask : a;
+}
+
+static uint64_t rotr(uint64_t a, unsigned n, unsigned width) {
+    return rotl(a, width - n % width, width);
+}
+
+int main() {
+    CastMode::set(CastMode::MANUAL);
+    auto c = Circuit();
+
+    //Constant operands fold gate by gate through the same circuits, so
+    //every 8 and 16 bit value can be checked against the compiler's
+    //builtins without a solver
+    bool counts8 = true, counts16 = true, bswap = true, rotates = true;
+    for (unsigned a = 0; a < 65536; ++a) {
+        Variable x((uint16_t)a, c.getPimpl());
+        counts16 = counts16 && equals(Variable::Popcount(x), __builtin_popcount(a))
+            && equals(Variable::Clz(x), a ? __builtin_clz(a) - 16 : 16)
+            && equals(Variable::Ctz(x), a ? __builtin_ctz(a) : 16);
+        bswap = bswap && equals(Variable::Bswap(x), __builtin_bswap16(a));
+        if (a < 256) {
+            Variable x8((uint8_t)a, c.getPimpl());
+            counts8 = counts8 && equals(Variable::Popcount(x8), __builtin_popcount(a))
+                && equals(Variable::Clz(x8), a ? __builtin_clz(a) - 24 : 8)
+                && equals(Variable::Ctz(x8), a ? __builtin_ctz(a) : 8);
+            for (unsigned k = 0; k < 20; ++k) {
+                rotates = rotates && equals(Variable::Rotl(x8, k), rotl(a, k, 8))
+                    && equals(Variable::Rotr(x8, k), rotr(a, k, 8));
+            }
+        }
+    }
+    check("Popcount, Clz and Ctz, 8 bits", counts8);
+    check("Popcount, Clz and Ctz, 16 bits", counts16);
+    check("Bswap", bswap);
+    check("rotates by constants", rotates);
+
+    //Amounts that are not constant go through the barrel shifter, so
+    //these are solved for every operand and a range of amounts.  Each
+    //case gets its own circuit to keep the solver's work small.
+    struct Case {
+        const char* name;
+        Variable (*build)(const Variable&, const Variable&);
+        unsigned width, amounts;
+        uint64_t (*expect)(uint64_t, unsigned);
+    };
+    std::vector<Case> cases = {
+        {"Rotl", [](const Variable& x, const Variable& n) { return Variable::Rotl(x, n); }, 8, 20,
+            [](uint64_t a, unsigned k) { return rotl(a, k, 8); }},
+        {"Rotr", [](const Variable& x, const Variable& n) { return Variable::Rotr(x, n); }, 8, 20,
+            [](uint64_t a, unsigned k) { return rotr(a, k, 8); }},
+        //not a power of two, so the amount is reduced with a remainder
+        {"Rotl, 6 bits", [](const Variable& x, const Variable& n) { return Variable::Rotl(x, n); }, 6, 256,
+            [](uint64_t a, unsigned k) { return rotl(a, k, 6); }},
+        {"Rotr, 6 bits", [](const Variable& x, const Variable& n) { return Variable::Rotr(x, n); }, 6, 256,
+            [](uint64_t a, unsigned k) { return rotr(a, k, 6); }},
+        {"Shl", [](const Variable& x, const Variable& n) { return x << n.cast(x.getTypeInfo()); }, 8, 8,
+            [](uint64_t a, unsigned k) -> uint64_t { return (uint8_t)(a << k); }},
+        {"Shr", [](const Variable& x, const Variable& n) { return x >> n.cast(x.getTypeInfo()); }, 8, 8,
+            [](uint64_t a, unsigned k) -> uint64_t { return (uint8_t)(a >> k); }},
+        {"signed Shr", [](const Variable& x, const Variable& n) {
+                auto s = x.cast(TypeInfo(true, 8));
+                return s >> n.cast(s.getTypeInfo());
+            }, 8, 8,
+            [](uint64_t a, unsigned k) -> uint64_t { return (uint8_t)((int8_t)a >> k); }},
+    };
+    for (auto& k : cases) {
+        auto kc = Circuit();
+        auto x_arg = kc.addArgument<uint8_t>();
+        auto n_arg = kc.addArgument<uint8_t>();
+        Variable x = Variable(x_arg).cast(TypeInfo(false, k.width));
+        Variable n(n_arg);
+        Variable result = k.build(x, n);
+        SolverSession s(kc);
+        bool ok = true;
+        for (unsigned a = 0; a < (1u << k.width) && ok; ++a) {
+            for (unsigned b = 0; b < k.amounts && ok; ++b) {
+                std::vector<int> lits;
+                assume(s, lits, x, a);
+                assume(s, lits, n, b);
+                assume(s, lits, result, k.expect(a, b));
+                ok = (bool)s.solve(lits);
+            }
+        }
+        check(k.name, ok);
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,17 @@
+#ifndef CHECK_H_INC
+#define CHECK_H_INC
+
+#include <iostream>
+
+//Each test prints one line per check and returns nonzero from main if
+//any failed.
+static int failures = 0;
+
+static void check(const char* what, bool ok) {
+    std::cout << what << ": " << (ok ? "ok" : "FAILED") << '\n';
+    if (!ok) {
+        ++failures;
+    }
+}
+
+#endif
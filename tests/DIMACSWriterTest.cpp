@@ -0,0 +1,49 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <stdint.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <CXXSat/Circuit.h>
+#include <CXXSat/Argument.h>
+#include <CXXSat/Variable.h>
+#include <CXXSat/Sat.h>
+#include "Check.h"
+
+int main() {
+    CastMode::set(CastMode::MANUAL);
+    auto c = Circuit();
+    auto x_arg = c.addArgument<uint16_t>();
+    auto y_arg = c.addArgument<uint16_t>();
+    Variable x(x_arg);
+    Variable y(y_arg);
+    auto target = x * y == (uint16_t)391 && x != (uint16_t)1;
+
+    //streamed, the same as the Problem would print
+    char path[] = "/tmp/DIMACSWriterTestXXXXXX";
+    int fd = mkstemp(path);
+    c.writeDIMACS(target, fd);
+    close(fd);
+    std::ifstream in(path);
+    std::stringstream written;
+    written << in.rdbuf();
+    unlink(path);
+    check("same as the Problem", written.str() == c.generateCNF(target).toDIMACS());
+
+    //a full disk is reported, not a short file
+    fd = open("/dev/full", O_WRONLY);
+    if (fd >= 0) {
+        bool thrown = false;
+        try {
+            c.writeDIMACS(target, fd);
+        }
+        catch (const std::system_error& e) {
+            thrown = e.code() == std::errc::no_space_on_device;
+        }
+        close(fd);
+        check("write errors", thrown);
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,71 @@
+#include <iostream>
+#include <set>
+#include <utility>
+#include <stdint.h>
+#include <CXXSat/Circuit.h>
+#include <CXXSat/Argument.h>
+#include <CXXSat/Variable.h>
+#include <CXXSat/Sat.h>
+#include "Check.h"
+
+typedef std::set<std::pair<unsigned, unsigned>> Pairs;
+
+int main() {
+    CastMode::set(CastMode::MANUAL);
+    auto c = Circuit();
+    auto x_arg = c.addArgument<uint8_t>();
+    auto y_arg = c.addArgument<uint8_t>();
+    Variable x(x_arg);
+    Variable y(y_arg);
+    auto p = c.generateCNF(x * y == (uint8_t)36);
+
+    //every pair whose product wraps to 36
+    Pairs expected;
+    for (unsigned a = 0; a < 256; ++a) {
+        for (unsigned b = 0; b < 256; ++b) {
+            if ((uint8_t)(a * b) == 36) {
+                expected.insert({a, b});
+            }
+        }
+    }
+    std::cout << expected.size() << " pairs\n";
+
+    for (unsigned threads : {1u, 3u}) {
+        Pairs found;
+        bool distinct = true, projected = true;
+        auto n = p.enumerate({x_arg, y_arg}, 0, [&](const Solution& s) {
+            unsigned a = x_arg.solution(s).as<unsigned>();
+            unsigned b = y_arg.solution(s).as<unsigned>();
+            distinct = found.insert({a, b}).second && distinct;
+            projected = projected && s.size() == 16;
+        }, threads);
+        std::cout << threads << " threads: " << n << " found\n";
+        check("all of them", found == expected && n == expected.size());
+        check("each once", distinct);
+        check("projected", projected);
+
+        //stops at the limit, with valid and distinct pairs
+        Pairs some;
+        bool valid = true;
+        n = p.enumerate({x_arg, y_arg}, 5, [&](const Solution& s) {
+            unsigned a = x_arg.solution(s).as<unsigned>();
+            unsigned b = y_arg.solution(s).as<unsigned>();
+            valid = valid && expected.count({a, b}) && some.insert({a, b}).second;
+        }, threads);
+        check("limit", n == 5 && some.size() == 5 && valid);
+    }
+
+    //over just x: the values with some y to go with them
+    std::set<unsigned> xs, expected_xs;
+    for (auto& ab : expected) {
+        expected_xs.insert(ab.first);
+    }
+    p.enumerate(x_arg.variables(), 0, [&](const Solution& s) {
+        xs.insert(x_arg.solution(s).as<unsigned>());
+    });
+    check("some of the variables", xs == expected_xs);
+
+    auto none = c.generateCNF(x * y == (uint8_t)36 && x == (uint8_t)0);
+    check("unsatisfiable", none.enumerate({x_arg, y_arg}, 0, [](const Solution&) {}, 2) == 0);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,45 @@
+#include <iostream>
+#include <stdint.h>
+#include <CXXSat/Circuit.h>
+#include <CXXSat/Argument.h>
+#include <CXXSat/Variable.h>
+#include <CXXSat/Expr.h>
+#include <CXXSat/Sat.h>
+#include "Check.h"
+
+int main() {
+    CastMode::set(CastMode::MANUAL);
+    auto c = Circuit();
+    auto x_arg = c.addArgument<uint16_t>();
+    auto y_arg = c.addArgument<uint16_t>();
+    Expr x(x_arg);
+    Expr y(y_arg);
+    Expr zero((uint16_t)0, c.getPimpl());
+    Expr one((uint16_t)1, c.getPimpl());
+
+    check("hash-consed leaves", x.same(Expr(x_arg)));
+    check("hash-consed operators", (x + y).same(y + x));
+    check("x + 0", (x + zero).same(x));
+    check("x * 1", (one * x).same(x));
+    check("x - x", (x - x).isZero());
+    check("x ^ x", (x ^ x).isZero());
+    check("~~x", (~~x).same(x));
+    check("constants", ((Expr((uint16_t)6, c.getPimpl()) * (uint16_t)7) == (uint16_t)42).isConstant());
+    check("x == x", (x == x).isConstant() && !(x == x).isZero());
+
+    //nothing has been blasted, so only the literals have clauses
+    check("no gates before blasting", c.generateCNF().numClauses() <= 2);
+
+    auto p = c.generateCNF((x * y == (uint16_t)391) && (x < y) && (x != one) && (x + zero - x == zero));
+    auto soln = p.solve();
+    if (soln) {
+        std::cout << x_arg.solution(soln) << ' ' << y_arg.solution(soln) << '\n';
+        auto a = x_arg.solution(soln).as<unsigned>();
+        auto b = y_arg.solution(soln).as<unsigned>();
+        check("solved", (uint16_t)(a * b) == 391 && a < b && a != 1);
+    }
+    else {
+        check("solved", false);
+    }
+    return failures ? 1 : 0;
+}
@@ -10,8 +10,10 @@
 int main(int argc, char** argv) {
     CastMode::set(CastMode::MANUAL);
     auto c = Circuit();
-    if (argc < 3 || argc > 4 || (argc == 4 && argv[3] != std::string("-dump"))) {
-        std::cerr << "USAGE: " + std::string(argv[0]) + " numbits prime [-dump]\n";
+    bool dump = (argc == 4 && argv[3] == std::string("-dump"));
+    bool cubes = (argc == 5 && argv[3] == std::string("-cubes"));
+    if (argc < 3 || (argc > 3 && !dump && !cubes)) {
+        std::cerr << "USAGE: " + std::string(argv[0]) + " numbits prime [-dump | -cubes k]\n";
         return 1;
     }
     int n = atoi(argv[1]);
@@ -21,11 +23,18 @@ int main(int argc, char** argv) {
     auto y = y_arg.asValue();
     auto z = c.getLiteral(FlexInt::fromString(argv[2], TypeInfo{false, n}));
     auto p = c.generateCNF(z == Variable::Mul_full(x, y));
-    if (argc == 4) {
+    if (dump) {
         p.printDIMACS(std::cout);
     }
     else {
-        auto soln = p.solve();
+        //split on the top k bits of each factor, across every core
+        unsigned k = cubes ? atoi(argv[4]) : 0;
+        auto vars = x_arg.topBits(k);
+        auto y_bits = y_arg.topBits(k);
+        vars.insert(vars.end(), y_bits.begin(), y_bits.end());
+        auto soln = cubes ? p.solveCubes(vars, 0, [](std::size_t done, std::size_t total) {
+                    std::cerr << done << '/' << total << " cubes refuted\n";
+                }) : p.solve();
         if (soln) {
             std::cout << x_arg.solution(soln) << ' ' << y_arg.solution(soln) << '\n';
         }
@@ -0,0 +1,83 @@
+#include <iostream>
+#include <type_traits>
+#include <stdint.h>
+#include <CXXSat/Circuit.h>
+#include <CXXSat/Argument.h>
+#include <CXXSat/Variable.h>
+#include <CXXSat/FixedVariable.h>
+#include <CXXSat/Sat.h>
+
+typedef FixedVariable<16, false> u16;
+typedef FixedVariable<32, true> s32;
+
+static_assert(std::is_same<decltype(std::declval<u16>() + std::declval<u16>()), u16>::value,
+        "no promotion to int");
+static_assert(std::is_same<decltype(std::declval<u16>() * 3), s32>::value,
+        "int literals are 32 bit signed");
+static_assert(std::is_same<decltype(std::declval<u16>() < std::declval<s32>()), FixedBit>::value,
+        "comparisons give a bit");
+
+//for a constant v: whether it holds value
+template <unsigned N, bool S>
+static bool holds(const FixedVariable<N, S>& v, uint64_t value) {
+    for (unsigned i = 0; i < N; ++i) {
+        const auto& bit = v.getBits()[i];
+        if (!bit.isLiteral() || bit.literalValue() != ((value >> i) & 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//Comparisons and shifts by a variable amount are built on the arrays;
+//constant operands fold gate by gate, so every 8 bit pair can be checked
+template <bool S>
+static bool brute_force(const Circuit& c) {
+    typedef FixedVariable<8, S> T;
+    typedef typename std::conditional<S, int8_t, uint8_t>::type Int;
+    for (unsigned i = 0; i < 256; ++i) {
+        T a((Int)i, c.getPimpl());
+        for (unsigned j = 0; j < 256; ++j) {
+            T b((Int)j, c.getPimpl());
+            if (!holds(a < b, (Int)i < (Int)j) || !holds(a <= b, (Int)i <= (Int)j)) {
+                std::cerr << "Less " << i << ' ' << j << '\n';
+                return false;
+            }
+        }
+        for (unsigned k = 0; k < 12; ++k) {
+            T n((Int)k, c.getPimpl());
+            //amounts past the width give zero, or -1 for signed right shifts
+            uint8_t shl = (k < 8) ? (uint8_t)(i << k) : 0;
+            uint8_t shr = (k < 8) ? (uint8_t)((Int)i >> k) : (S ? 0xff : 0);
+            if (!holds(a << n, shl) || !holds(a >> n, shr)) {
+                std::cerr << "shift " << i << ' ' << k << '\n';
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main() {
+    auto c = Circuit();
+    if (!brute_force<false>(c) || !brute_force<true>(c)) {
+        return 1;
+    }
+    auto x_arg = c.addArgument<uint16_t>();
+    auto y_arg = c.addArgument<uint16_t>();
+    u16 x(x_arg);
+    u16 y(y_arg);
+    //mixing with the dynamic Variable
+    Variable product = Variable::Mul_full(x, y);
+    auto p = c.generateCNF(FixedVariable<32, false>(product) == 391U &&
+            x < y && x != (uint16_t)1 && (x + y) - y == x);
+    auto soln = p.solve();
+    if (!soln) {
+        std::cerr << "UNSAT\n";
+        return 1;
+    }
+    auto a = x_arg.solution(soln).as<unsigned>();
+    auto b = y_arg.solution(soln).as<unsigned>();
+    std::cout << a << ' ' << b << '\n';
+    return (a * b == 391 && a < b && a != 1) ? 0 : 1;
+}
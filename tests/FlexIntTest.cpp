@@ -1,9 +1,30 @@
 #include <CXXSat/FlexInt.h>
 #include <iostream>
+#include <sstream>
+#include <string>
+#include "Check.h"
+
+static std::string str(const FlexInt& i) {
+    std::ostringstream out;
+    out << i;
+    return out.str();
+}
 
 int main() {
     FlexInt x{'c'};
     const FlexInt& y = x.cast(TypeInfo(true, 32));
     std::cout << x.getTypeInfo() << ' ' << y.getTypeInfo() << '\n';
-    return 0;
+    check("cast", x.getTypeInfo() == TypeInfo(true, 8) && y.getTypeInfo() == TypeInfo(true, 32));
+    //wider than 64 bits: (2^64 - 59) * (2^64 - 83), and back
+    TypeInfo wide{false, 128};
+    auto p = FlexInt::fromString("18446744073709551557", wide);
+    auto q = FlexInt::fromString("18446744073709551533", wide);
+    auto n = p * q;
+    std::cout << n << ' ' << n / p << ' ' << n % q << ' ' << n.getTypeInfo() << '\n';
+    check("128 bit product", str(n) == "340282366920938460843936948965011886881");
+    check("128 bit quotient", str(n / p) == "18446744073709551533");
+    check("128 bit remainder", str(n % q) == "0");
+    check("128 bit negative", str(-FlexInt::fromString("1", TypeInfo{true, 128})) == "-1");
+    check("high half", str((n >> FlexInt{64}.cast(wide)).cast(TypeInfo{false, 64})) == "18446744073709551474");
+    return failures ? 1 : 0;
 }
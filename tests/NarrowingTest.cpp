@@ -0,0 +1,89 @@
+#include <iostream>
+#include <vector>
+#include <stdint.h>
+#include <CXXSat/Circuit.h>
+#include <CXXSat/Argument.h>
+#include <CXXSat/Variable.h>
+#include <CXXSat/Sat.h>
+#include <CXXSat/SolverSession.h>
+#include "Check.h"
+
+//assumes the bits of v are those of value
+static void assume(SolverSession& s, std::vector<int>& lits, const Variable& v, uint64_t value) {
+    auto bits = v.view();
+    for (unsigned i = 0; i < bits.size(); ++i) {
+        int lit = s.literal(Variable(bits[i]));
+        lits.push_back(((value >> i) & 1) ? lit : -lit);
+    }
+}
+
+int main() {
+    //Operands with only their low nibbles unknown, zero or sign extended
+    //the rest of the way, so the operators narrow them.  A uint8_t
+    //holding a sign extended nibble is wider unsigned than signed, and
+    //must not be narrowed to a signed type.
+    CastMode::set(CastMode::MANUAL);
+    auto c = Circuit();
+    auto x_arg = c.addArgument<uint8_t>();
+    auto y_arg = c.addArgument<uint8_t>();
+    Variable x(x_arg);
+    Variable y(y_arg);
+    Variable ux = x.cast(TypeInfo(true, 4)).cast(TypeInfo(false, 8));
+    Variable uy = y.cast(TypeInfo(false, 4)).cast(TypeInfo(false, 8));
+    Variable sx = x.cast(TypeInfo(true, 4)).cast(TypeInfo(true, 8));
+    Variable sy = y.cast(TypeInfo(false, 4)).cast(TypeInfo(true, 8));
+    struct Case {
+        const char* name;
+        Variable result;
+        uint64_t (*expect)(uint8_t, uint8_t);
+    };
+    //a and b are the operands' values as uint8_t
+    std::vector<Case> cases = {
+        {"unsigned Mul_full", Variable::Mul_full(ux, uy),
+            [](uint8_t a, uint8_t b) -> uint64_t { return (uint16_t)(a * b); }},
+        {"unsigned Mul_full, swapped", Variable::Mul_full(uy, ux),
+            [](uint8_t a, uint8_t b) -> uint64_t { return (uint16_t)(a * b); }},
+        {"unsigned Mul", ux * uy,
+            [](uint8_t a, uint8_t b) -> uint64_t { return (uint8_t)(a * b); }},
+        {"unsigned Add", ux + uy,
+            [](uint8_t a, uint8_t b) -> uint64_t { return (uint8_t)(a + b); }},
+        {"unsigned Sub", ux - uy,
+            [](uint8_t a, uint8_t b) -> uint64_t { return (uint8_t)(a - b); }},
+        {"unsigned Less", ux < uy,
+            [](uint8_t a, uint8_t b) -> uint64_t { return a < b; }},
+        {"unsigned Equal", ux == uy,
+            [](uint8_t a, uint8_t b) -> uint64_t { return a == b; }},
+        {"mixed Mul_full", Variable::Mul_full(sx, sy),
+            [](uint8_t a, uint8_t b) -> uint64_t { return (uint16_t)((int8_t)a * (int8_t)b); }},
+        {"signed Less", sx < sy,
+            [](uint8_t a, uint8_t b) -> uint64_t { return (int8_t)a < (int8_t)b; }},
+        {"signed Sub", sx - sy,
+            [](uint8_t a, uint8_t b) -> uint64_t { return (uint8_t)((int8_t)a - (int8_t)b); }},
+    };
+    //C's promotions: a uint8_t times an int16_t, multiplied as ints
+    CastMode::set(CastMode::C_STYLE);
+    cases.push_back({"promoted Mul", uy * sx.cast(TypeInfo(true, 16)),
+            [](uint8_t a, uint8_t b) -> uint64_t { return (uint32_t)(b * (int16_t)(int8_t)a); }});
+    cases.push_back({"promoted Mul by a constant", uy * Variable((int16_t)28074, c.getPimpl()),
+            [](uint8_t, uint8_t b) -> uint64_t { return (uint32_t)(b * 28074); }});
+    CastMode::set(CastMode::MANUAL);
+
+    SolverSession s(c);
+    for (auto& k : cases) {
+        bool ok = true;
+        for (unsigned i = 0; i < 16 && ok; ++i) {
+            for (unsigned j = 0; j < 16 && ok; ++j) {
+                //the operands' values, as the nibbles are extended
+                uint8_t a = (i & 8) ? (i | 0xf0) : i;
+                uint8_t b = j;
+                std::vector<int> lits;
+                assume(s, lits, x, i);
+                assume(s, lits, y, j);
+                assume(s, lits, k.result, k.expect(a, b));
+                ok = (bool)s.solve(lits);
+            }
+        }
+        check(k.name, ok);
+    }
+    return failures ? 1 : 0;
+}
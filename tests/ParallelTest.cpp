@@ -0,0 +1,45 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <CXXSat/Circuit.h>
+#include <CXXSat/Argument.h>
+#include <CXXSat/Variable.h>
+#include <CXXSat/Sat.h>
+#include "Check.h"
+
+int main() {
+    CastMode::set(CastMode::MANUAL);
+    auto c = Circuit();
+    auto x_arg = c.addArgument<uint8_t>();
+    auto y_arg = c.addArgument<uint8_t>();
+    Variable x(x_arg);
+    Variable y(y_arg);
+    auto factor = [&](uint16_t n) {
+        return c.generateCNF(Variable::Mul_full(x, y) == n && x != (uint8_t)1 && y != (uint8_t)1 && x <= y);
+    };
+
+    //whichever thread answers first, its model must be one
+    auto p = factor(391);
+    for (unsigned threads : {1u, 2u, 3u}) {
+        for (const auto& names : {std::vector<std::string>{}, std::vector<std::string>{"minisat"}}) {
+            auto soln = p.solveParallel(threads, names);
+            bool ok = soln && soln.status() == Solution::Status::SAT;
+            if (ok) {
+                auto a = x_arg.solution(soln).as<unsigned>();
+                auto b = y_arg.solution(soln).as<unsigned>();
+                std::cout << a << ' ' << b << '\n';
+                ok = a == 17 && b == 23;
+            }
+            check(names.empty() ? "factored" : "factored, named", ok);
+        }
+    }
+
+    //251 is prime, so every thread must prove there is nothing to find
+    auto prime = factor(251);
+    for (unsigned threads : {1u, 3u}) {
+        auto soln = prime.solveParallel(threads);
+        check("unsatisfiable", !soln && soln.status() == Solution::Status::UNSAT);
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,78 @@
+#include <iostream>
+#include <random>
+#include <stdint.h>
+#include <CXXSat/Circuit.h>
+#include <CXXSat/Argument.h>
+#include <CXXSat/Variable.h>
+#include <CXXSat/Sat.h>
+#include <CXXSat/Preprocessor.h>
+#include "Check.h"
+
+static bool satisfies(const Solution& soln, const Problem& p) {
+    for (auto clause : p) {
+        bool sat = false;
+        for (int lit : clause) {
+            sat = sat || (soln[std::abs(lit)] == (lit > 0));
+        }
+        if (!sat) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    CastMode::set(CastMode::MANUAL);
+    auto c = Circuit();
+    auto x_arg = c.addArgument<uint16_t>();
+    auto y_arg = c.addArgument<uint16_t>();
+    Variable x(x_arg);
+    Variable y(y_arg);
+    auto p = c.generateCNF(x * y == (uint16_t)391 && x != (uint16_t)1 && y != (uint16_t)1 && x <= y);
+
+    Preprocessor pre(p);
+    pre.freeze(x_arg.variables());
+    pre.freeze(y_arg.variables());
+    auto q = pre.simplify();
+    std::cout << p.numClauses() << " clauses, " << q.numClauses() << " after; "
+        << pre.stats().eliminated << " eliminated, " << pre.stats().substituted << " substituted\n";
+    check("shrinks", q.numClauses() < p.numClauses() * 9 / 10 && pre.stats().eliminated > 0);
+    check("keeps the numbering", q.numVars() == p.numVars());
+
+    auto soln = q.solve();
+    check("solved", (bool)soln);
+    if (soln) {
+        //the arguments are frozen, so they decode without reconstructing
+        auto a = x_arg.solution(soln).as<unsigned>();
+        auto b = y_arg.solution(soln).as<unsigned>();
+        std::cout << a << ' ' << b << '\n';
+        check("factors", (uint16_t)(a * b) == 391 && a != 1 && b != 1 && a <= b);
+        check("reconstructed", satisfies(pre.reconstruct(soln), p));
+    }
+
+    Preprocessor none(c.generateCNF(x * y == (uint16_t)391 && x == (uint16_t)0));
+    check("unsatisfiable", !none.simplify().solve());
+
+    //small random 3-SAT problems near the threshold, half of them
+    //satisfiable, with a few variables frozen
+    std::mt19937 rng(1);
+    bool agree = true, models = true;
+    for (int i = 0; i < 50; ++i) {
+        const int vars = 40;
+        Problem r;
+        std::uniform_int_distribution<int> var(1, vars);
+        for (int j = 0; j < 170; ++j) {
+            r.addClause({var(rng) * (rng() % 2 ? 1 : -1), var(rng) * (rng() % 2 ? 1 : -1),
+                    var(rng) * (rng() % 2 ? 1 : -1)});
+        }
+        r.addVariables(vars);
+        Preprocessor rp(r);
+        rp.freeze({1, 2, 3, 4, 5});
+        auto s = rp.simplify().solve();
+        agree = agree && ((bool)s == (bool)r.solve());
+        models = models && (!s || satisfies(rp.reconstruct(s), r));
+    }
+    check("random problems agree", agree);
+    check("random models reconstructed", models);
+    return failures ? 1 : 0;
+}
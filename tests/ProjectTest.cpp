@@ -0,0 +1,61 @@
+#include <iostream>
+#include <stdexcept>
+#include <stdint.h>
+#include <CXXSat/Circuit.h>
+#include <CXXSat/Argument.h>
+#include <CXXSat/Variable.h>
+#include <CXXSat/Sat.h>
+#include "Check.h"
+
+static bool thrown(const Solution& soln, int var) {
+    try {
+        soln.at(var);
+    }
+    catch (const std::out_of_range&) {
+        return true;
+    }
+    return false;
+}
+
+int main() {
+    CastMode::set(CastMode::MANUAL);
+    auto c = Circuit();
+    auto x_arg = c.addArgument<uint8_t>();
+    auto y_arg = c.addArgument<uint8_t>();
+    Variable x(x_arg);
+    Variable y(y_arg);
+    auto p = c.generateCNF(Variable::Mul_full(x, y) == (uint16_t)391 && x != (uint8_t)1 && y != (uint8_t)1 && x <= y);
+    auto full = p.solve();
+    check("every variable", full && full.size() > 16);
+
+    //only x is kept, and decodes as before
+    p.project(x_arg.variables());
+    auto soln = p.solve();
+    check("projected", soln && soln.size() == 8);
+    check("decoded", soln && x_arg.solution(soln).as<unsigned>() == 17);
+    bool kept = true, dropped = true;
+    for (int v : x_arg.variables()) {
+        kept = kept && !thrown(soln, v) && soln.at(v) == soln[v];
+    }
+    for (int v : y_arg.variables()) {
+        dropped = dropped && thrown(soln, v) && !soln[v];
+    }
+    check("kept", kept);
+    check("dropped", dropped && thrown(soln, 0) && thrown(soln, -1));
+
+    //both, through a parallel solve
+    auto both = x_arg.variables();
+    for (int v : y_arg.variables()) {
+        both.push_back(v);
+    }
+    p.project(both);
+    soln = p.solveParallel(2);
+    check("both", soln && soln.size() == 16 && y_arg.solution(soln).as<unsigned>() == 23);
+
+    //and every variable again
+    p.project({});
+    soln = p.solve();
+    check("unprojected", soln && soln.size() == full.size() && !thrown(soln, soln.size()));
+    check("past the end", thrown(soln, soln.size() + 1));
+    return failures ? 1 : 0;
+}
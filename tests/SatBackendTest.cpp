@@ -0,0 +1,81 @@
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <stdint.h>
+#include <CXXSat/Circuit.h>
+#include <CXXSat/Argument.h>
+#include <CXXSat/Variable.h>
+#include <CXXSat/Sat.h>
+#include <CXXSat/SatBackend.h>
+#include <CXXSat/SolverSession.h>
+#include "Check.h"
+
+static bool rejected(const std::string& name) {
+    try {
+        SatBackend::create(name);
+    }
+    catch (const std::invalid_argument& e) {
+        std::cout << e.what() << '\n';
+        return true;
+    }
+    return false;
+}
+
+//Usage: SatBackendTest [path to the IPASIR stub library]
+int main(int argc, char** argv) {
+    //built alongside the tests from tests/stub
+    std::string stub = std::string("ipasir:") + (argc > 1 ? argv[1] : "./libipasirstub.so");
+
+    check("unknown name", rejected("nope"));
+    check("missing library", rejected("ipasir:/nonexistent/libipasir.so"));
+    //loads, but isn't a solver
+    check("missing symbols", rejected("ipasir:libm.so.6"));
+
+    CastMode::set(CastMode::MANUAL);
+    auto c = Circuit();
+    auto x_arg = c.addArgument<uint16_t>();
+    auto y_arg = c.addArgument<uint16_t>();
+    Variable x(x_arg);
+    Variable y(y_arg);
+    auto p = c.generateCNF(x * y == (uint16_t)391 && x != (uint16_t)1 && y != (uint16_t)1 && x <= y);
+
+    for (const std::string& name : {std::string("minisat"), stub}) {
+        std::cout << name << '\n';
+        std::unique_ptr<SatBackend> backend;
+        try {
+            backend = SatBackend::create(name);
+        }
+        catch (const std::invalid_argument& e) {
+            std::cout << e.what() << '\n';
+            check("loaded", false);
+            continue;
+        }
+        check("named", backend->name() == (name == "minisat" ? name : "ipasir:stub"));
+        auto soln = p.solve(*backend);
+        check("solved", (bool)soln);
+        if (soln) {
+            auto a = x_arg.solution(soln).as<unsigned>();
+            auto b = y_arg.solution(soln).as<unsigned>();
+            check("factors", (uint16_t)(a * b) == 391 && a != 1 && b != 1 && a <= b);
+        }
+
+        //incrementally, through a session
+        SolverSession s(c, SatBackend::create(name));
+        auto sum = s.solve(x + y == (uint16_t)10 && x == (uint16_t)3);
+        check("session", sum && y_arg.solution(sum).as<unsigned>() == 7);
+        check("session, unsatisfiable", !s.solve(x == (uint16_t)3 && x == (uint16_t)4));
+        check("session, again", (bool)s.solve(x == (uint16_t)4));
+
+        //an interrupt before solving stops the next solve, and only that
+        auto raw = SatBackend::create(name);
+        int lits[] = {1, 2};
+        raw->addClause(lits, 2);
+        raw->interrupt();
+        check("interrupted", raw->solve() == SatBackend::UNKNOWN);
+        check("interrupt forgotten", raw->solve() == SatBackend::SAT);
+        raw->assume(-1);
+        check("assumed", raw->solve() == SatBackend::SAT && raw->value(2) && !raw->value(1));
+        check("assumption dropped", raw->numVars() == 2 && raw->solve() == SatBackend::SAT);
+    }
+    return failures ? 1 : 0;
+}
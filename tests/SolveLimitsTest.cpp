@@ -0,0 +1,100 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <stdint.h>
+#include <CXXSat/Circuit.h>
+#include <CXXSat/Argument.h>
+#include <CXXSat/Variable.h>
+#include <CXXSat/Sat.h>
+#include "Check.h"
+
+static double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool unknown(const Solution& soln) {
+    return soln.status() == Solution::Status::UNKNOWN;
+}
+
+int main() {
+    CastMode::set(CastMode::MANUAL);
+    auto c = Circuit();
+    auto x_arg = c.addArgument<uint32_t>();
+    auto y_arg = c.addArgument<uint32_t>();
+    Variable x(x_arg);
+    Variable y(y_arg);
+    //2^61 - 1 is prime, so this is unsatisfiable, and refuting a 32 by 32
+    //bit multiplier takes any solver far longer than the limits allow
+    auto p = c.generateCNF(Variable::Mul_full(x, y) == (uint64_t)2305843009213693951ull
+            && x != (uint32_t)1 && y != (uint32_t)1);
+    auto vars = x_arg.topBits(2);
+    auto y_bits = y_arg.topBits(2);
+    vars.insert(vars.end(), y_bits.begin(), y_bits.end());
+
+    {
+        SolveLimits limits;
+        limits.conflicts = 10;
+        check("conflicts", unknown(p.solve(limits)));
+    }
+    {
+        SolveLimits limits;
+        limits.seconds = 0.3;
+        auto start = std::chrono::steady_clock::now();
+        check("seconds", unknown(p.solve(limits)) && since(start) < 3);
+        start = std::chrono::steady_clock::now();
+        check("seconds, in parallel", unknown(p.solveParallel(2, {}, limits)) && since(start) < 3);
+        //the limit is for the whole call, not each of the 16 cubes
+        start = std::chrono::steady_clock::now();
+        check("seconds, in cubes", unknown(p.solveCubes(vars, 2, {}, limits)) && since(start) < 3);
+        //likewise for every cube of an enumeration
+        bool complete = true;
+        start = std::chrono::steady_clock::now();
+        auto n = p.enumerate({x_arg, y_arg}, 0, [](const Solution&) {}, 2, limits, &complete);
+        check("seconds, enumerating", n == 0 && !complete && since(start) < 3);
+    }
+    {
+        SolveLimits limits;
+        limits.conflicts = 10;
+        bool complete = true;
+        auto n = p.enumerate({x_arg, y_arg}, 0, [](const Solution&) {}, 1, limits, &complete);
+        check("conflicts, enumerating", n == 0 && !complete);
+    }
+    {
+        SolveLimits limits;
+        limits.memory = 1;
+        auto start = std::chrono::steady_clock::now();
+        check("memory, in cubes", unknown(p.solveCubes(vars, 2, {}, limits)) && since(start) < 3);
+    }
+    {
+        SolveLimits limits;
+        auto start = std::chrono::steady_clock::now();
+        std::thread canceller([&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(300));
+            limits.cancel();
+        });
+        auto soln = p.solveCubes(vars, 2, {}, limits);
+        canceller.join();
+        check("cancel", unknown(soln) && limits.cancelled() && since(start) < 3);
+        start = std::chrono::steady_clock::now();
+        check("cancelled before solving", unknown(p.solve(limits)) && since(start) < 1);
+        bool complete = true;
+        p.enumerate({x_arg, y_arg}, 0, [](const Solution&) {}, 2, limits, &complete);
+        check("cancelled before enumerating", !complete && since(start) < 1);
+    }
+    //the limits are lifted again afterwards
+    auto easy = c.generateCNF(x * y == (uint32_t)391 && x != (uint32_t)1 && y != (uint32_t)1);
+    SolveLimits limits;
+    limits.seconds = 60;
+    check("solved within limits", (bool)easy.solve(limits));
+    auto small = Circuit();
+    auto a_arg = small.addArgument<uint8_t>();
+    auto b_arg = small.addArgument<uint8_t>();
+    Variable a(a_arg);
+    Variable b(b_arg);
+    auto factors = small.generateCNF(Variable::Mul_full(a, b) == (uint16_t)391
+            && a != (uint8_t)1 && b != (uint8_t)1);
+    bool complete = false;
+    auto n = factors.enumerate({a_arg, b_arg}, 0, [](const Solution&) {}, 2, limits, &complete);
+    check("enumerated within limits", n == 2 && complete);
+    return failures ? 1 : 0;
+}
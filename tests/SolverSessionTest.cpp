@@ -0,0 +1,71 @@
+#include <iostream>
+#include <stdint.h>
+#include <CXXSat/Circuit.h>
+#include <CXXSat/Argument.h>
+#include <CXXSat/Variable.h>
+#include <CXXSat/Sat.h>
+#include <CXXSat/SolverSession.h>
+#include "Check.h"
+
+int main() {
+    CastMode::set(CastMode::MANUAL);
+    auto c = Circuit();
+    auto x_arg = c.addArgument<uint16_t>();
+    auto y_arg = c.addArgument<uint16_t>();
+    Variable x(x_arg);
+    Variable y(y_arg);
+    auto product = x * y;
+
+    SolverSession s(c);
+    s.require(x != (uint16_t)1 && y != (uint16_t)1);
+    s.require(x <= y);
+    auto clauses = s.numClauses();
+
+    auto soln = s.solve(product == (uint16_t)391);
+    check("solved", (bool)soln);
+    if (soln) {
+        auto a = x_arg.solution(soln).as<unsigned>();
+        auto b = y_arg.solution(soln).as<unsigned>();
+        std::cout << a << ' ' << b << '\n';
+        check("factors", (uint16_t)(a * b) == 391 && a != 1 && b != 1 && a <= b);
+    }
+    auto grown = s.numClauses();
+    check("encoded the multiplier", grown > clauses);
+
+    //the multiplier is already there, so only the comparison is new
+    auto again = s.solve(product == (uint16_t)323);
+    check("solved again", (bool)again);
+    if (again) {
+        auto a = x_arg.solution(again).as<unsigned>();
+        auto b = y_arg.solution(again).as<unsigned>();
+        check("factors again", (uint16_t)(a * b) == 323 && a != 1 && b != 1 && a <= b);
+    }
+    check("reused the multiplier", s.numClauses() - grown < (grown - clauses) / 4);
+
+    //assumptions are dropped after each query
+    auto zero = s.literal(x == (uint16_t)0);
+    check("assumptions hold", !s.solve({zero, s.literal(product == (uint16_t)391)}));
+    check("assumption dropped", (bool)s.solve(product == (uint16_t)323));
+
+    //generateCNF and other sessions renumber the shared wires, and the
+    //session must put its numbers back before encoding and decoding.
+    //The targets are built (and the session brought up to date) first,
+    //so nothing else would make it restore.
+    auto factors = [&](const Solution& soln, unsigned n) {
+        return soln && (uint16_t)(x_arg.solution(soln).as<unsigned>() *
+                y_arg.solution(soln).as<unsigned>()) == n;
+    };
+    auto p437 = product == (uint16_t)437;
+    auto p391 = product == (uint16_t)391;
+    s.solve();
+    c.generateCNF();
+    check("after generateCNF", factors(s.solve(p437), 437));
+    SolverSession t(c);
+    check("other session", factors(t.solve(p391), 391));
+    check("after another session", factors(s.solve(p391), 391));
+    //a new argument is numbered even when nothing else changed
+    auto z_arg = c.addArgument<uint8_t>();
+    auto z = s.solve(Variable(z_arg) == (uint8_t)9);
+    check("new argument", z && z_arg.solution(z).as<unsigned>() == 9);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,105 @@
+#include <iostream>
+#include <vector>
+#include <stdint.h>
+#include <CXXSat/Circuit.h>
+#include <CXXSat/Argument.h>
+#include <CXXSat/Variable.h>
+#include <CXXSat/Expr.h>
+#include <CXXSat/Sat.h>
+#include <CXXSat/SolverSession.h>
+#include "Check.h"
+
+//for a constant v: whether it holds value
+static bool equals(const Variable& v, uint64_t value) {
+    Variable eq = v == Variable(value, v.getCircuit(), v.getTypeInfo());
+    return eq.isConstant() && eq.unsignedWidth() == 1;
+}
+
+//assumes the bits of v are those of value
+static void assume(SolverSession& s, std::vector<int>& lits, const Variable& v, uint64_t value) {
+    auto bits = v.view();
+    for (unsigned i = 0; i < bits.size(); ++i) {
+        int lit = s.literal(Variable(bits[i]));
+        lits.push_back(((value >> i) & 1) ? lit : -lit);
+    }
+}
+
+int main() {
+    auto c = Circuit();
+
+    //Constant terms fold gate by gate through the adder tree, so sums
+    //of every 8 bit value can be checked without a solver.  Negative
+    //terms narrower than the sum take the inverted sign bit path.
+    CastMode::set(CastMode::MANUAL);
+    bool unsigned8 = true, signed8 = true;
+    for (unsigned a = 0; a < 256; ++a) {
+        for (unsigned b = 0; b < 256; b += 5) {
+            uint8_t k = a ^ b;
+            unsigned sum = a + b + k + 200 + 1;
+            unsigned8 = unsigned8 && equals(Variable::Sum({
+                    Variable((uint8_t)a, c.getPimpl()), Variable((uint8_t)b, c.getPimpl()),
+                    Variable(k, c.getPimpl()), Variable((uint8_t)200, c.getPimpl()),
+                    Variable((uint8_t)1, c.getPimpl())}), (uint8_t)sum);
+            int ssum = (int8_t)a + (int8_t)b + (int8_t)k + (int8_t)-1;
+            signed8 = signed8 && equals(Variable::Sum({
+                    Variable((int8_t)a, c.getPimpl()), Variable((int8_t)b, c.getPimpl()),
+                    Variable((int8_t)k, c.getPimpl()), Variable((int8_t)-1, c.getPimpl())}),
+                    (uint8_t)ssum);
+        }
+    }
+    check("unsigned 8 bits", unsigned8);
+    check("signed 8 bits", signed8);
+
+    //mixed types convert as a chain of Adds would: in C_STYLE, to int
+    CastMode::set(CastMode::C_STYLE);
+    bool promoted = true;
+    for (unsigned a = 0; a < 256; ++a) {
+        for (int16_t d : {-32768, -300, -1, 0, 1, 1000, 32767}) {
+            uint8_t b = a * 37;
+            int sum = (int8_t)a + b + d + (int8_t)-128;
+            auto v = Variable::Sum({Variable((int8_t)a, c.getPimpl()), Variable(b, c.getPimpl()),
+                    Variable(d, c.getPimpl()), Variable((int8_t)-128, c.getPimpl())});
+            promoted = promoted && v.getTypeInfo() == TypeInfo(true, 32) && equals(v, (uint32_t)sum);
+        }
+    }
+    check("promoted to int", promoted);
+    //unsigned prevails at the same size
+    auto mixed = Variable::Sum({Variable((int32_t)-5, c.getPimpl()), Variable((uint32_t)3, c.getPimpl()),
+            Variable((int8_t)1, c.getPimpl())});
+    check("converted to unsigned", mixed.getTypeInfo() == TypeInfo(false, 32) &&
+            equals(mixed, (uint32_t)-1));
+
+    //Terms that are not constant: sign and zero extended nibbles, so
+    //the tree is narrowed, and a whole byte.  An Expr chain of Adds is
+    //summed all at once and must agree.
+    auto x_arg = c.addArgument<uint8_t>();
+    auto y_arg = c.addArgument<uint8_t>();
+    Variable x(x_arg);
+    Variable y(y_arg);
+    Variable sx = x.cast(TypeInfo(true, 4)).cast(TypeInfo(true, 8));
+    Variable uy = y.cast(TypeInfo(false, 4));
+    Variable k((int16_t)-1000, c.getPimpl());
+    Variable sum = Variable::Sum({sx, uy, y, k, sx});
+    //blasted once the partial sums are only held by the chain
+    Expr chain = Expr(sx) + Expr(uy) + Expr(y) + Expr(k) + Expr(sx);
+    Variable expr = chain.blast();
+    SolverSession s(c);
+    bool solved = true, chained = true;
+    for (unsigned i = 0; i < 16 && (solved || chained); ++i) {
+        for (unsigned j = 0; j < 256 && (solved || chained); j += 3) {
+            //the nibble of x sign extended, and of y zero extended
+            int expect = 2*(int8_t)((i & 8) ? (i | 0xf0) : i) + (j & 15) + j - 1000;
+            std::vector<int> lits;
+            assume(s, lits, x, i);
+            assume(s, lits, y, j);
+            auto both = lits;
+            assume(s, lits, sum, (uint32_t)expect);
+            solved = solved && s.solve(lits);
+            assume(s, both, expr, (uint32_t)expect);
+            chained = chained && s.solve(both);
+        }
+    }
+    check("solved", solved);
+    check("as an Expr", chained);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,89 @@
+//A minimal IPASIR solver around Minisat, built as a shared library so
+//SatBackendTest can load it the way it would load CaDiCaL or Kissat.
+
+#include <cstdlib>
+#include <minisat/core/Solver.h>
+#include <minisat/core/SolverTypes.h>
+
+namespace {
+
+struct Stub {
+    Minisat::Solver solver;
+    Minisat::vec<Minisat::Lit> clause;
+    Minisat::vec<Minisat::Lit> assumptions;
+    void* state = nullptr;
+    int (*terminate)(void*) = nullptr;
+
+    Minisat::Lit lit(int x) {
+        int var = std::abs(x) - 1;
+        while (var >= solver.nVars()) {
+            solver.newVar();
+        }
+        return (x > 0) ? Minisat::mkLit(var) : ~Minisat::mkLit(var);
+    }
+};
+
+}
+
+extern "C" {
+
+const char* ipasir_signature() {
+    return "stub";
+}
+
+void* ipasir_init() {
+    return new Stub;
+}
+
+void ipasir_release(void* s) {
+    delete static_cast<Stub*>(s);
+}
+
+void ipasir_add(void* p, int x) {
+    auto s = static_cast<Stub*>(p);
+    if (x) {
+        s->clause.push(s->lit(x));
+    }
+    else {
+        s->solver.addClause_(s->clause);
+        s->clause.clear();
+    }
+}
+
+void ipasir_assume(void* p, int x) {
+    auto s = static_cast<Stub*>(p);
+    s->assumptions.push(s->lit(x));
+}
+
+int ipasir_solve(void* p) {
+    auto s = static_cast<Stub*>(p);
+    //Minisat can't call back during the search, so termination is only
+    //asked for before it starts
+    int result = 0;
+    if (!s->terminate || !s->terminate(s->state)) {
+        auto r = s->solver.solveLimited(s->assumptions);
+        result = (r == Minisat::l_True) ? 10 : (r == Minisat::l_False) ? 20 : 0;
+    }
+    s->assumptions.clear();
+    return result;
+}
+
+int ipasir_val(void* p, int lit) {
+    auto s = static_cast<Stub*>(p);
+    int var = std::abs(lit);
+    return (s->solver.model[var - 1] == Minisat::l_True) ? var : -var;
+}
+
+int ipasir_failed(void*, int) {
+    return 0;
+}
+
+void ipasir_set_terminate(void* p, void* state, int (*terminate)(void*)) {
+    auto s = static_cast<Stub*>(p);
+    s->state = state;
+    s->terminate = terminate;
+}
+
+void ipasir_set_learn(void*, void*, int, void (*)(void*, int*)) {}
+
+}